@@ -0,0 +1,71 @@
+#!/bin/sh
+# @file bench.sh
+# @author
+# @date 13.11.2022
+#
+# @brief Benchmark of the supervisor and its generators
+# @details Generates Erdos-Renyi, planted 3 colourable and geometric graphs and solves
+# every graph with 1 up to BENCH_GENERATORS generators for BENCH_TIME seconds.
+# Appends one CSV row per run to BENCH_OUT, so the rows of different builds
+# can be compared. Run it through make bench.
+#
+# BENCH_SIZES       vertices:edges of the graphs (default "40:50 4000:1600")
+# BENCH_TYPES       kinds of graphs (default "er planted geometric")
+# BENCH_GENERATORS  most generators (default number of cores)
+# BENCH_TIME        seconds per run (default 5)
+# BENCH_SEED        seed of the graphs (default 1)
+# BENCH_OUT         CSV file (default bench.csv)
+# BENCH_LABEL       name of the build (default git describe)
+
+sizes=${BENCH_SIZES:-"40:50 4000:1600"}
+types=${BENCH_TYPES:-"er planted geometric"}
+most=${BENCH_GENERATORS:-$(getconf _NPROCESSORS_ONLN)}
+seconds=${BENCH_TIME:-5}
+seed=${BENCH_SEED:-1}
+out=${BENCH_OUT:-bench.csv}
+label=${BENCH_LABEL:-$(git describe --always --dirty 2>/dev/null || echo unknown)}
+
+work=$(mktemp -d) || exit 1
+trap 'rm -rf "$work"' EXIT
+trap 'exit 1' INT TERM
+
+if [ ! -s "$out" ]; then
+    echo "build,graph,vertices,edges,generators,seconds,best,time_to_best,attempts_per_s,write_wait_ms,free_wait_ms" > "$out"
+fi
+
+# 1, 2, 4, ... and the most generators
+counts=""
+n=1
+while [ "$n" -lt "$most" ]; do
+    counts="$counts $n"
+    n=$((n * 2))
+done
+counts="$counts $most"
+
+for type in $types; do
+    for size in $sizes; do
+        vertices=${size%%:*}
+        edges=${size##*:}
+        graph="$work/$type-$vertices.txt"
+        ./graphgen -t "$type" -s "$seed" "$vertices" "$edges" > "$graph" || exit 1
+        edges=$(grep -vc '^#' "$graph")
+
+        for generators in $counts; do
+            dump="$work/dump.csv"
+            ./supervisor -I bench -n "$generators" -t "$seconds" -D "$dump" "$graph" > /dev/null || exit 1
+
+            # the last rows are the counters on exit
+            awk -F, -v build="$label" -v graph="$type" -v vertices="$vertices" -v edges="$edges" \
+                -v generators="$generators" '
+                NR == 1 { next }
+                $1 != time { time = $1; attempts = 0; write = 0; free = 0 }
+                $2 == "generator" { attempts += $5; write += $8; free += $9 }
+                $2 == "supervisor" { best = $12; found = $13 }
+                END {
+                    rate = time > 0 ? attempts / time : 0
+                    printf "%s,%s,%s,%s,%s,%.3f,%s,%s,%.0f,%.1f,%.1f\n", build, graph, vertices, edges,
+                        generators, time, best, found, rate, write / 1e6, free / 1e6
+                }' "$dump" | tee -a "$out"
+        done
+    done
+done
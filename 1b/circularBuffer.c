@@ -12,8 +12,18 @@
 #include <stdio.h>
 #include <errno.h>
 #include <stdbool.h>
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+#include <ctype.h>
+#include <signal.h>
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 #include "circularBuffer.h"
+#include "graph.h"
+#include "solution.h"
 
 //Semaphores
 sem_t *free_sem;
@@ -25,34 +35,375 @@ int shmfd;
 
 //Circular buffer
 struct Buffer *buffer;
+static size_t buffer_size = sizeof(struct Buffer);
 
+//Set by use_huge_pages before the buffer exists
+static bool huge_pages = false;
+
+//Seconds after which a buffer without a supervisor pid is stale
+#define STARTUP_SECONDS (10)
+
+//Set by set_colours before the buffer exists
+static int buffer_colours = 3;
+
+//Instance the shared objects belong to, empty for the default instance
+static char instance_id[MAX_INSTANCE_ID + 1] = "";
+
+//Statistics slot of this generator, the spare one if all slots are taken
+struct GeneratorStats *generator_stats;
+static struct GeneratorStats spare_stats;
+
+
+int set_instance(const char *id){
+    size_t length = strlen(id);
+    if(length == 0 || length > MAX_INSTANCE_ID){
+        return -1;
+    }
+
+    for(size_t i = 0; i < length; i++){
+        if(!isalnum((unsigned char)id[i]) && id[i] != '-'){
+            return -1;
+        }
+    }
+
+    strcpy(instance_id, id);
+    return 0;
+}
+
+void instance_name(char *name, const char *object){
+    if(instance_id[0] == '\0'){
+        snprintf(name, MAX_NAME, "%s_%s", NAME_PREFIX, object);
+    }
+    else{
+        snprintf(name, MAX_NAME, "%s_%s_%s", NAME_PREFIX, instance_id, object);
+    }
+}
+
+/**
+  * Unlink Instance function
+  * @brief Unlink every shared object of the instance
+  * @return true if anything existed
+**/
+static bool unlink_instance(void){
+    const char *shms[] = {SHM_NAME, SHM_GRAPH, SHM_SOLUTION};
+    const char *sems[] = {SEM_FREE, SEM_USE, SEM_WRITE};
+    char name[MAX_NAME];
+    bool existed = false;
+
+    for(size_t i = 0; i < sizeof(shms) / sizeof(shms[0]); i++){
+        instance_name(name, shms[i]);
+        existed |= shm_unlink(name) == 0;
+    }
+    for(size_t i = 0; i < sizeof(sems) / sizeof(sems[0]); i++){
+        instance_name(name, sems[i]);
+        existed |= sem_unlink(name) == 0;
+    }
+    return existed;
+}
+
+int remove_stale_instance(void){
+    char name[MAX_NAME];
+    instance_name(name, SHM_NAME);
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if(fd != -1){
+        struct stat st;
+        if(fstat(fd, &st) == -1){
+            close(fd);
+            return -1;
+        }
+
+        //Reading past the end of a segment which isn't sized yet would fault
+        pid_t pid = 0;
+        if(st.st_size >= (off_t)sizeof(struct Buffer)){
+            struct Buffer *existing = mmap(NULL, sizeof(*existing), PROT_READ, MAP_SHARED, fd, 0);
+            if(existing != MAP_FAILED){
+                pid = __atomic_load_n(&existing->supervisor_pid, __ATOMIC_ACQUIRE);
+                munmap(existing, sizeof(*existing));
+            }
+        }
+        close(fd);
+
+        //No pid yet, the supervisor is still starting unless it began long ago
+        if(pid == 0){
+            if(time(NULL) - st.st_ctime < STARTUP_SECONDS){
+                return -1;
+            }
+        }
+        else if(kill(pid, 0) == 0 || errno == EPERM){
+            return -1;
+        }
+    }
+
+    if(unlink_instance()){
+        fprintf(stderr, "Removed stale instance %s. \n", name);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+  * Instance Of Entry function
+  * @brief Get the instance of an entry in /dev/shm
+  * @param entry name of the entry
+  * @param id the instance is stored here, empty for the default instance
+  * @return true if the entry belongs to an instance
+**/
+static bool instance_of_entry(const char *entry, char *id){
+    const char *objects[] = {SHM_NAME, SHM_GRAPH, SHM_SOLUTION, SEM_FREE, SEM_USE, SEM_WRITE};
+    const char *prefix = NAME_PREFIX + 1;
+
+    //Named semaphores show up as sem.<name>
+    if(strncmp(entry, "sem.", 4) == 0){
+        entry += 4;
+    }
+    if(strncmp(entry, prefix, strlen(prefix)) != 0 || entry[strlen(prefix)] != '_'){
+        return false;
+    }
+    entry += strlen(prefix) + 1;
+
+    for(size_t i = 0; i < sizeof(objects) / sizeof(objects[0]); i++){
+        size_t length = strlen(entry);
+        size_t objectLength = strlen(objects[i]);
+
+        if(length == objectLength && strcmp(entry, objects[i]) == 0){
+            id[0] = '\0';
+            return true;
+        }
+        if(length > objectLength + 1 && length - objectLength - 1 <= MAX_INSTANCE_ID
+            && strcmp(entry + length - objectLength, objects[i]) == 0 && entry[length - objectLength - 1] == '_'){
+            memcpy(id, entry, length - objectLength - 1);
+            id[length - objectLength - 1] = '\0';
+            return true;
+        }
+    }
+    return false;
+}
+
+int remove_stale_instances(void){
+    DIR *dir = opendir("/dev/shm");
+    if(dir == NULL){
+        return -1;
+    }
+
+    char saved[MAX_INSTANCE_ID + 1];
+    strcpy(saved, instance_id);
+
+    //Collect the instances first, removing entries while reading the directory may skip some
+    char (*ids)[MAX_INSTANCE_ID + 1] = NULL;
+    size_t count = 0;
+    struct dirent *entry;
+    while((entry = readdir(dir)) != NULL){
+        char id[MAX_INSTANCE_ID + 1];
+        if(!instance_of_entry(entry->d_name, id)){
+            continue;
+        }
+
+        bool seen = false;
+        for(size_t i = 0; i < count && !seen; i++){
+            seen = strcmp(ids[i], id) == 0;
+        }
+        if(seen){
+            continue;
+        }
+
+        char (*grown)[MAX_INSTANCE_ID + 1] = realloc(ids, (count + 1) * sizeof(*ids));
+        if(grown == NULL){
+            break;
+        }
+        ids = grown;
+        strcpy(ids[count++], id);
+    }
+    closedir(dir);
+
+    int removed = 0;
+    for(size_t i = 0; i < count; i++){
+        strcpy(instance_id, ids[i]);
+        if(remove_stale_instance() == 1){
+            removed++;
+        }
+    }
+
+    free(ids);
+    strcpy(instance_id, saved);
+    return removed;
+}
 
 void set_state(bool state){
-     buffer->stop = state;
+     __atomic_store_n(&buffer->stop, state, __ATOMIC_SEQ_CST);
 }
 
 bool get_state(void){
-    return buffer->stop;
+    return __atomic_load_n(&buffer->stop, __ATOMIC_SEQ_CST);
+}
+
+int get_best(void){
+    return __atomic_load_n(&buffer->best_amount, __ATOMIC_RELAXED);
+}
+
+void set_best(int amount){
+    __atomic_store_n(&buffer->best_amount, amount, __ATOMIC_RELAXED);
+}
+
+void use_huge_pages(void){
+    huge_pages = true;
+}
+
+int advise_huge_pages(void *memory, size_t size){
+    if(!huge_pages){
+        return 0;
+    }
+#ifdef MADV_HUGEPAGE
+    return madvise(memory, size, MADV_HUGEPAGE);
+#else
+    errno = EINVAL;
+    return -1;
+#endif
+}
+
+int get_colours(void){
+    return buffer->colours;
+}
+
+void set_colours(int colours){
+    buffer_colours = colours;
+}
+
+int get_generator_count(void){
+    return buffer->generator_count;
+}
+
+void set_generator_count(int count){
+    buffer->generator_count = count;
+}
+
+int generator_slot(void){
+    if(generator_stats == NULL || generator_stats == &spare_stats){
+        return -1;
+    }
+    return (int)(generator_stats - buffer->generator_stats);
+}
+
+/**
+  * Claim Stats function
+  * @brief Claim a statistics slot for this generator
+**/
+static void claim_stats(void){
+    pid_t pid = getpid();
+    generator_stats = &spare_stats;
+
+    for(int i = 0; i < MAX_GENERATORS; i++){
+        pid_t expected = 0;
+        if(__atomic_compare_exchange_n(&buffer->generator_stats[i].pid, &expected, pid,
+            false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)){
+            generator_stats = &buffer->generator_stats[i];
+            memset((char *)generator_stats + sizeof(pid_t), 0, sizeof(*generator_stats) - sizeof(pid_t));
+            return;
+        }
+    }
+}
+
+/**
+  * Release Stats function
+  * @brief Give the statistics slot of this generator back
+**/
+static void release_stats(void){
+    if(generator_stats != NULL && generator_stats != &spare_stats){
+        __atomic_store_n(&generator_stats->pid, 0, __ATOMIC_RELEASE);
+    }
+    generator_stats = NULL;
+}
+
+/**
+  * Elapsed Nanoseconds function
+  * @brief Nanoseconds between two points of time
+  * @param start
+  * @param end
+  * @return the nanoseconds
+**/
+static unsigned long long elapsed_ns(const struct timespec *start, const struct timespec *end){
+    return (end->tv_sec - start->tv_sec) * 1000000000ULL + end->tv_nsec - start->tv_nsec;
 }
 
 
 void clean_exit(bool isSupervisor){
     if(isSupervisor){
         fprintf(stdout, "Shutting down everything. \n");
-        sem_post(free_sem);
-        set_state(true);
+        stop_generators();
         close_buffer(isSupervisor);
         exit(EXIT_SUCCESS);
     }
     else{
         fprintf(stdout, "Shutting down generator. \n");
-        sem_post(free_sem);
         close_buffer(isSupervisor);
         exit(EXIT_SUCCESS);
     }
    
 }
 
+/**
+  * Futex function
+  * @brief Wait on or wake a futex in the shared buffer
+  * @details Not private, the futex is shared between processes.
+  * @param word the futex word
+  * @param op FUTEX_WAIT or FUTEX_WAKE
+  * @param value expected value for FUTEX_WAIT, number of waiters for FUTEX_WAKE
+  * @return the result of the system call
+**/
+static long futex(unsigned int *word, int op, unsigned int value){
+    return syscall(SYS_futex, word, op, value, NULL, NULL, 0);
+}
+
+/**
+  * Wake Producers function
+  * @brief Wake every generator blocked in write_to_buffer
+  * @details Called after posting a semaphore generators may wait on and to stop them.
+  * The futex system call is skipped when nobody waits.
+**/
+static void wake_producers(void){
+    __atomic_add_fetch(&buffer->producer_seq, 1, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&buffer->producers_waiting, __ATOMIC_SEQ_CST) > 0){
+        futex(&buffer->producer_seq, FUTEX_WAKE, INT_MAX);
+    }
+}
+
+/**
+  * Producer Wait function
+  * @brief Wait for a semaphore as a generator
+  * @details Instead of sleeping in sem_wait, generators sleep on the producer futex,
+  * which is woken whenever the semaphore may have been posted and when the
+  * generators are stopped. The sequence is read before trying the semaphore, so
+  * a post in between makes the futex wait return right away.
+  * @param sem the semaphore
+  * @return 0 if the semaphore was taken, -1 if the generators are stopped
+**/
+static int producer_wait(sem_t *sem){
+    for(;;){
+        unsigned int seq = __atomic_load_n(&buffer->producer_seq, __ATOMIC_SEQ_CST);
+
+        if(get_state()){
+            return -1;
+        }
+        if(sem_trywait(sem) == 0){
+            return 0;
+        }
+        if(errno != EAGAIN && errno != EINTR){
+            failed_exit("Sem wait for the buffer failed. \n");
+        }
+
+        __atomic_add_fetch(&buffer->producers_waiting, 1, __ATOMIC_SEQ_CST);
+        if(futex(&buffer->producer_seq, FUTEX_WAIT, seq) == -1 && errno != EAGAIN && errno != EINTR){
+            failed_exit("Futex wait failed. \n");
+        }
+        __atomic_sub_fetch(&buffer->producers_waiting, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+void stop_generators(void){
+    set_state(true);
+    wake_producers();
+}
+
 void failed_exit(char *err_msg){
     fprintf(stderr, err_msg);
     exit(EXIT_FAILURE);
@@ -63,9 +414,14 @@ void failed_exit(char *err_msg){
   * @brief Open semaphores for the supervisor
 **/
 void open_semaphones_supervisor(void){
-     free_sem = sem_open(SEM_FREE, O_CREAT | O_EXCL, 0600, BUFFER_SIZE);
-     use_sem = sem_open(SEM_USE, O_CREAT | O_EXCL, 0600, 0);
-     write_sem = sem_open(SEM_WRITE, O_CREAT | O_EXCL, 0600, 1);
+     char name[MAX_NAME];
+
+     instance_name(name, SEM_FREE);
+     free_sem = sem_open(name, O_CREAT | O_EXCL, 0600, BUFFER_SIZE);
+     instance_name(name, SEM_USE);
+     use_sem = sem_open(name, O_CREAT | O_EXCL, 0600, 0);
+     instance_name(name, SEM_WRITE);
+     write_sem = sem_open(name, O_CREAT | O_EXCL, 0600, 1);
        
         
     if(free_sem == SEM_FAILED || use_sem == SEM_FAILED || write_sem == SEM_FAILED){
@@ -80,10 +436,18 @@ void open_semaphones_supervisor(void){
   * @brief Open semaphores for the generators
 **/
 void open_semaphones_generator(void){
-     free_sem = sem_open(SEM_FREE, BUFFER_SIZE);
-     use_sem = sem_open(SEM_USE, 0);
-     write_sem = sem_open(SEM_WRITE, 1);
-       
+     char name[MAX_NAME];
+
+     instance_name(name, SEM_FREE);
+     free_sem = sem_open(name, 0);
+     instance_name(name, SEM_USE);
+     use_sem = sem_open(name, 0);
+     instance_name(name, SEM_WRITE);
+     write_sem = sem_open(name, 0);
+
+    if(free_sem == SEM_FAILED || use_sem == SEM_FAILED || write_sem == SEM_FAILED){
+        failed_exit("Couldn't open the semaphones. Is the supervisor running? \n");
+    }
 } 
 
 /**
@@ -97,7 +461,14 @@ void close_semaphones(bool isSupervisor){
     }
     
     if(isSupervisor){
-        if(sem_unlink(SEM_WRITE) == -1 || sem_unlink(SEM_FREE) == -1 || sem_unlink(SEM_USE) == -1){
+        char write_name[MAX_NAME];
+        char free_name[MAX_NAME];
+        char use_name[MAX_NAME];
+        instance_name(write_name, SEM_WRITE);
+        instance_name(free_name, SEM_FREE);
+        instance_name(use_name, SEM_USE);
+
+        if(sem_unlink(write_name) == -1 || sem_unlink(free_name) == -1 || sem_unlink(use_name) == -1){
             failed_exit("Couldn't unlink semaphones properly. \n");
         }
     }  
@@ -105,34 +476,65 @@ void close_semaphones(bool isSupervisor){
 
 
 void open_buffer(bool isSupervisor){
-    shmfd = shm_open(SHM_NAME, O_RDWR | O_CREAT, 0600);
+    char name[MAX_NAME];
+    instance_name(name, SHM_NAME);
+
+    if(isSupervisor){
+        if(remove_stale_instance() == -1){
+            failed_exit("The instance is already running, choose another one with -I. \n");
+        }
+        shmfd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    }
+    else{
+        shmfd = shm_open(name, O_RDWR, 0);
+    }
    
     if (shmfd == -1){
-        close_buffer(isSupervisor);
-        failed_exit("Couldn't open share memory. \n");
+        failed_exit("Couldn't open share memory. Is the supervisor running? \n");
     }
 
     if(isSupervisor){
-        if(ftruncate(shmfd, sizeof(*buffer)) < 0){
-            close_buffer(isSupervisor);
+        //A huge page can only back a whole huge page of the object
+        if(huge_pages){
+            buffer_size = (sizeof(*buffer) + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+        }
+        if(ftruncate(shmfd, buffer_size) < 0){
+            close(shmfd);
+            shm_unlink(name);
             failed_exit("Ftruncate failed. \n");
         }
     }
 
    
-    buffer = mmap(NULL, sizeof(*buffer), PROT_READ | PROT_WRITE, MAP_SHARED, shmfd, 0);
+    buffer = mmap(NULL, buffer_size, PROT_READ | PROT_WRITE, MAP_SHARED, shmfd, 0);
 
     if (buffer == MAP_FAILED){
-        close_buffer(isSupervisor);
+        close(shmfd);
+        if(isSupervisor){
+            shm_unlink(name);
+        }
         failed_exit("mmap faile. \n");
     }
 
     if(isSupervisor){
+        //Before the first write, the page is chosen when it is touched
+        if(advise_huge_pages(buffer, buffer_size) == -1){
+            fprintf(stderr, "Huge pages aren't available, using normal pages. \n");
+            huge_pages = false;
+        }
+        memset(buffer, 0, sizeof(*buffer));
+        buffer->huge_pages = huge_pages;
+        buffer->colours = buffer_colours;
         open_semaphones_supervisor();
+        set_best(INT_MAX);
         set_state(false);
+        //The pid marks the instance as started, everything else exists by now
+        __atomic_store_n(&buffer->supervisor_pid, getpid(), __ATOMIC_RELEASE);
     }
     else{
+        huge_pages = buffer->huge_pages;
         open_semaphones_generator();
+        claim_stats();
     }
     
 }
@@ -141,7 +543,11 @@ void open_buffer(bool isSupervisor){
 
 
 void close_buffer(bool isSupervisor){
-    if(munmap(buffer, sizeof(*buffer)) == -1){
+    if(!isSupervisor){
+        release_stats();
+    }
+
+    if(munmap(buffer, buffer_size) == -1){
         failed_exit("Couldn't unmap shared memory properly. \n");
     }
 
@@ -150,36 +556,42 @@ void close_buffer(bool isSupervisor){
     }
 
     if(isSupervisor){
-        if(shm_unlink(SHM_NAME) == -1){
+        char name[MAX_NAME];
+        instance_name(name, SHM_NAME);
+        if(shm_unlink(name) == -1){
             failed_exit("Couldn't unlink shared memory. \n");
         }
     }
    
     close_semaphones(isSupervisor);
-
+    close_solution(isSupervisor);
+    close_graph(isSupervisor);
 
 }
 
 void write_to_buffer(struct Result *result){
-    if(sem_wait(write_sem) == -1){
-        if(errno == EINTR){
-            clean_exit(false);
-        }
-        else{
-            failed_exit("Sem wait for write semaphone failed. \n");
-        }
+    struct timespec start;
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if(producer_wait(write_sem) == -1){
+        return;
     }
 
-    if(sem_wait(free_sem) == -1){
-        if(errno == EINTR){
-            clean_exit(false);
-        }
-        else{
-            failed_exit("Sem wait for free semaphone failed. \n");
-        }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    STAT_ADD(generator_stats->write_wait_ns, elapsed_ns(&start, &end));
+
+    if(producer_wait(free_sem) == -1){
+        //Stopped, let the next generator see it as well
+        sem_post(write_sem);
+        wake_producers();
+        return;
     }
 
-    buffer->results[buffer->write_index] = *result;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    STAT_ADD(generator_stats->free_wait_ns, elapsed_ns(&end, &start));
+
+    buffer->results[buffer->write_index].result = *result;
     buffer->write_index += 1;
     buffer->write_index %= BUFFER_SIZE;
 
@@ -190,12 +602,17 @@ void write_to_buffer(struct Result *result){
     if(sem_post(write_sem) == -1){
         failed_exit("Sem post for free semaphone failed. \n");
     }
+    wake_producers();
+
+    STAT_ADD(generator_stats->published, 1);
 }
 
-void read_from_buffer(struct Result *result){
-    if(sem_wait(use_sem)==-1){
-        if(errno == EINTR){
-            clean_exit(true);
+int read_from_buffer(struct Result *result, const struct timespec *deadline){
+    int ret = deadline == NULL ? sem_wait(use_sem) : sem_timedwait(use_sem, deadline);
+
+    if(ret == -1){
+        if(errno == EINTR || errno == ETIMEDOUT){
+            return -1;
         }
         else{
            failed_exit("Sem wait for use semaphone failed. \n");
@@ -203,21 +620,35 @@ void read_from_buffer(struct Result *result){
     }
 
 
-    *result = buffer->results[buffer->read_index];
+    *result = buffer->results[buffer->read_index].result;
     buffer->read_index+=1;
     buffer->read_index%=BUFFER_SIZE;
     
     if(sem_post(free_sem) == -1){
         failed_exit("Sem post for free semaphone failed. \n");
     }        
+    wake_producers();
     
+    STAT_ADD(buffer->supervisor_stats.drained, 1);
+    return 0;
 }
 
 
 void print_result(struct Result *result){
-    fprintf(stdout, "Soultion with removed %d edges(s): ", result->amount);
-    for(int i = 0; i < result->amount; i++){
-        fprintf(stdout, "%d-%d ", result->edges[i].n1.value, result->edges[i].n2.value);
+    print_results(result, 1);
+}
+
+void print_results(const struct Result *results, int count){
+    int amount = 0;
+    for(int c = 0; c < count; c++){
+        amount += results[c].amount;
+    }
+
+    fprintf(stdout, "Soultion with removed %d edges(s): ", amount);
+    for(int c = 0; c < count; c++){
+        for(int i = 0; i < results[c].amount; i++){
+            fprintf(stdout, "%d-%d ", results[c].edges[i].n1.value, results[c].edges[i].n2.value);
+        }
     }
     fprintf(stdout, "\n");
     
@@ -10,25 +10,39 @@
 #include <semaphore.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <sys/types.h>
+#include <time.h>
 
 
 #ifndef CIRCULARBUFFER_H
 #define CIRCULARBUFFER_H
 
 
-#define SHM_NAME "/11937894_shm"
-#define SEM_FREE "/11937894_sem_free"
-#define SEM_USE "/11937894_sem_use"
-#define SEM_WRITE "/11937894_sem_write"
+//Every shared object is named NAME_PREFIX[_ID]_<object>
+#define NAME_PREFIX "/11937894"
+#define SHM_NAME "shm"
+#define SEM_FREE "sem_free"
+#define SEM_USE "sem_use"
+#define SEM_WRITE "sem_write"
+#define MAX_INSTANCE_ID (32)
+#define MAX_NAME (64)
 
 extern int shfmd;
 extern struct Buffer *buffer;
 extern sem_t *free_sem;
 extern sem_t *use_sem;
 extern sem_t *write_sem;
+extern struct GeneratorStats *generator_stats;
 
 #define MAX_EDGES (8)
 #define BUFFER_SIZE (5)
+#define MAX_GENERATORS (64)
+#define CACHE_LINE (64)
+#define HUGE_PAGE (2 * 1024 * 1024)
+
+//Counters have a single writer, so a relaxed store is enough for the readers
+#define STAT_ADD(counter, amount) __atomic_store_n(&(counter), (counter) + (amount), __ATOMIC_RELAXED)
+#define STAT_GET(counter) __atomic_load_n(&(counter), __ATOMIC_RELAXED)
 
 
 /**
@@ -56,32 +70,122 @@ struct Edge{
   * @brief The representation of a result
   * @details An optimal result produced by the generator and read by the supervisor.
   * A result has the number of removed edges and those edges. 
+  * It belongs to one connected component of the graph.
 **/
 struct Result{
     int amount;
+    int component;
     struct Edge edges[MAX_EDGES];
 };
 
+/**
+  * Structure for the result slot
+  * @brief A result in the buffer
+  * @details Every slot starts on its own cache line, so a generator writing one slot
+  * doesn't invalidate the slot the supervisor is reading.
+**/
+struct ResultSlot{
+    struct Result result;
+} __attribute__((aligned(CACHE_LINE)));
+
+/**
+  * Structure for the generator statistics
+  * @brief The counters of one generator
+  * @details Every generator claims one slot and is the only one writing it.
+  * Each slot has its own cache line, so the generators don't slow each other down.
+**/
+struct GeneratorStats{
+    pid_t pid;
+    unsigned long long attempts;
+    unsigned long long published;
+    unsigned long long filtered;
+    unsigned long long write_wait_ns;
+    unsigned long long free_wait_ns;
+} __attribute__((aligned(CACHE_LINE)));
+
+/**
+  * Structure for the supervisor statistics
+  * @brief The counters of the supervisor
+  * @details drained counts the results read from the buffer.
+**/
+struct SupervisorStats{
+    unsigned long long drained;
+} __attribute__((aligned(CACHE_LINE)));
+
 /**
   * Structure for the circular buffer
   * @brief The representation of a buffer
   * @details The shared circular buffer containing read- write-index, the results and state telling the generators to stop or not.
+  * The best amount lets generators drop results which can't improve the solution anyway.
+  * The pid of the supervisor tells a later supervisor whether the instance is stale.
+  * Generators waiting for the buffer sleep on the producer_seq futex.
   * A generator writes to the shared ciruclar buffer the results and the supervisor reads them from the shared circular buffer.
+  * Fields written by different sides sit on different cache lines: the control line is
+  * written rarely, write_index only by the generator holding write_sem, the futex by
+  * waiting generators and read_index only by the supervisor.
 **/
 struct Buffer{
-    int read_index;
-    int write_index;
-    struct Result results[BUFFER_SIZE];
-    bool stop;
+    //Control line
+    bool stop __attribute__((aligned(CACHE_LINE)));
+    pid_t supervisor_pid;
+    int generator_count;
+    int colours;
+    int best_amount;
+    bool huge_pages;
+    //Producer line
+    int write_index __attribute__((aligned(CACHE_LINE)));
+    //Wait line
+    unsigned int producer_seq __attribute__((aligned(CACHE_LINE)));
+    int producers_waiting;
+    //Consumer line
+    int read_index __attribute__((aligned(CACHE_LINE)));
+    struct ResultSlot results[BUFFER_SIZE];
+    struct SupervisorStats supervisor_stats;
+    struct GeneratorStats generator_stats[MAX_GENERATORS];
 };
 
 
+/**
+  * Set Instance function
+  * @brief Select the instance the shared objects belong to
+  * @details Must be called before open_buffer. Without it the default instance is used.
+  * @param id the instance id, letters, digits and '-' only
+  * @return 0 on success, -1 for an invalid id
+**/
+int set_instance(const char *id);
+
+/**
+  * Instance Name function
+  * @brief Name of a shared object of the current instance
+  * @param name at least MAX_NAME bytes, the name is stored here
+  * @param object the object, e.g. SHM_NAME
+**/
+void instance_name(char *name, const char *object);
+
+/**
+  * Remove Stale Instance function
+  * @brief Remove the shared objects of the current instance if its supervisor is gone
+  * @details A buffer without a supervisor pid, also one which isn't sized yet, belongs
+  * to a supervisor which is still starting and is kept. It is only stale once it was
+  * created more than 10 seconds ago.
+  * @return 1 if a stale instance was removed, 0 if there was none, -1 if the supervisor is still running
+**/
+int remove_stale_instance(void);
+
+/**
+  * Remove Stale Instances function
+  * @brief Remove every stale instance found in /dev/shm
+  * @return number of removed instances, -1 if /dev/shm couldn't be read
+**/
+int remove_stale_instances(void);
+
 /**
   * Open Buffer function
   * @brief Open the circular buffer as a supervisor or generator.
   * @details Setup the shared memory and semaphores for the supervisor and the generators. 
   * The supervisor must first opens the shared buffer. And then the generator opens it. 
-  * Else the program will crash. 
+  * Else the generator exits with an error. A stale instance left behind by a crashed
+  * supervisor is removed first, a running one makes the supervisor exit. 
   * @param isSupervisor checking if the supervisor called the function or not. Based on the param 
   * function will do slightly different things.
 **/
@@ -90,7 +194,7 @@ void open_buffer(bool isSupervisor);
 /**
   * Close Buffer function
   * @brief Close the circular buffer as a supervisor or generator.
-  * @details Shared memory and all semaphores are closed for the supervisor and generator.
+  * @details Shared memory, the shared graph and all semaphores are closed for the supervisor and generator.
   * @param isSupervisor checking if the supervisor called the function or not. Based on the param 
   * function will do slightly different things.
 **/
@@ -100,7 +204,8 @@ void close_buffer(bool isSupervisor);
   * Write To Buffer function
   * @brief Write to the circular buffer
   * @details A generator writes to the shared memory a result
-  * which it found using the 3 colouring algorithm.
+  * which it found using the k colouring algorithm. Returns without
+  * writing if the generators are stopped while waiting.
   * @param result The found result
 **/
 void write_to_buffer(struct Result *result);
@@ -112,8 +217,10 @@ void write_to_buffer(struct Result *result);
   * from the shared memory, which was produced by
   * a generator.
   * @param result The found result will be written to the memory address of this variable 
+  * @param deadline absolute CLOCK_REALTIME time to stop waiting, NULL to wait until a result arrives
+  * @return 0 on success, -1 if the wait was interrupted by a signal or the deadline passed
 **/
-void read_from_buffer(struct Result *result);
+int read_from_buffer(struct Result *result, const struct timespec *deadline);
 
 /**
   * Print Result function
@@ -124,6 +231,16 @@ void read_from_buffer(struct Result *result);
 **/
 void print_result(struct Result *result);
 
+/**
+  * Print Results function
+  * @brief Print the results of all components as one solution
+  * @details The amounts are added up and the removed edges of every
+  * component are printed one after another.
+  * @param results the best result of every component
+  * @param count number of components
+**/
+void print_results(const struct Result *results, int count);
+
 /**
   * Get State function
   * @brief Get the state 
@@ -141,6 +258,85 @@ bool get_state(void);
 **/
 void set_state(bool state);
 
+/**
+  * Get Best function
+  * @brief Get the amount of the best result read so far
+  * @details Used by generators to drop results which are not better.
+  * @return the amount, INT_MAX before the first result
+**/
+int get_best(void);
+
+/**
+  * Set Best function
+  * @brief Set the amount of the best result read so far
+  * @param amount the amount
+**/
+void set_best(int amount);
+
+/**
+  * Use Huge Pages function
+  * @brief Back the shared objects with huge pages if the system has them
+  * @details Must be called by the supervisor before open_buffer. The generators
+  * follow the choice of the supervisor.
+**/
+void use_huge_pages(void);
+
+/**
+  * Advise Huge Pages function
+  * @brief Ask for huge pages for a mapping of a shared object
+  * @details Does nothing unless the supervisor chose huge pages. Has to be called before
+  * the mapping is first touched.
+  * @param memory the mapping
+  * @param size size of the mapping
+  * @return 0 on success or if nothing was done, -1 if huge pages aren't available
+**/
+int advise_huge_pages(void *memory, size_t size);
+
+/**
+  * Get Colours function
+  * @brief Number of colours the generators use
+  * @return the number
+**/
+int get_colours(void);
+
+/**
+  * Set Colours function
+  * @brief Set the number of colours the generators use
+  * @details Must be called by the supervisor before open_buffer, the buffer starts
+  * with it, so no generator sees another number. The default is 3.
+  * @param colours the number
+**/
+void set_colours(int colours);
+
+/**
+  * Get Generator Count function
+  * @brief Number of generators started by the supervisor
+  * @return the number, 0 if the generators are started by hand
+**/
+int get_generator_count(void);
+
+/**
+  * Set Generator Count function
+  * @brief Set the number of generators started by the supervisor
+  * @param count the number
+**/
+void set_generator_count(int count);
+
+/**
+  * Generator Slot function
+  * @brief The statistics slot of this generator
+  * @return the slot, -1 if all slots were taken
+**/
+int generator_slot(void);
+
+/**
+  * Stop Generators function
+  * @brief Tell the generators to stop and wake them up
+  * @details Sets the state to stop and broadcasts on the producer futex, so every
+  * generator blocked in write_to_buffer returns immediately.
+**/
+void stop_generators(void);
+
 /**
   * Clean Exit function
   * @brief Function for clean exiting with EXIT SUCCESS and closing the resources.
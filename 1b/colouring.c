@@ -0,0 +1,257 @@
+/**
+  * @file colouring.c
+  * @author
+  * @date 13.11.2022
+  * @brief Implementation of colouring.h
+**/
+
+#include <limits.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "colouring.h"
+
+
+void seed_random(struct Random *random, uint64_t seed){
+    //splitmix64 step, so similar seeds give unrelated states and the state is never 0
+    seed += 0x9E3779B97F4A7C15ULL;
+    seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+    seed ^= seed >> 31;
+    random->state = seed != 0 ? seed : 1;
+}
+
+struct Result generate_result(const struct Graph *graph, int component, const unsigned char *colours){
+    struct Result result;
+    int removedEdges = 0;
+    result.component = component;
+    for(int i = graph->component_edges[component]; i < graph->component_edges[component + 1]; i++){
+        int u = graph->edges[i].u;
+        int v = graph->edges[i].v;
+
+        if(colours[u] == colours[v]){
+            if(removedEdges >= MAX_EDGES){
+                result.amount = INT_MAX;
+                return result;
+            }
+            result.edges[removedEdges].n1.value = graph->labels[u];
+            result.edges[removedEdges].n1.colour = colours[u];
+            result.edges[removedEdges].n2.value = graph->labels[v];
+            result.edges[removedEdges].n2.colour = colours[v];
+            removedEdges++;
+        }
+    }
+
+    result.amount = removedEdges;
+    return result;
+}
+
+//A power of two k takes BITS bits per colour, so one draw colours 64 / BITS
+//vertices and the colour is a constant mask
+#define DEFINE_POW2_KERNEL(K, BITS) \
+static struct Result kernel_##K(const struct Graph *graph, int component, unsigned char *colours, \
+    struct Random *random, int k){ \
+    const int *vertices = graph->component_vertices; \
+    uint64_t bits = 0; \
+    int left = 0; \
+    (void)k; \
+    for(int i = graph->component_vertex_offsets[component]; i < graph->component_vertex_offsets[component + 1]; i++){ \
+        if(left == 0){ \
+            bits = next_random(random); \
+            left = 64 / (BITS); \
+        } \
+        colours[vertices[i]] = (unsigned char)(bits & ((K) - 1)); \
+        bits >>= (BITS); \
+        left--; \
+    } \
+    return generate_result(graph, component, colours); \
+}
+
+//Any other k maps 32 random bits to [0, k) with a multiplication,
+//so one draw colours two vertices
+#define DEFINE_KERNEL(NAME, K) \
+static struct Result kernel_##NAME(const struct Graph *graph, int component, unsigned char *colours, \
+    struct Random *random, int k){ \
+    const int *vertices = graph->component_vertices; \
+    uint64_t bits = 0; \
+    bool high = false; \
+    (void)k; \
+    for(int i = graph->component_vertex_offsets[component]; i < graph->component_vertex_offsets[component + 1]; i++){ \
+        uint32_t draw; \
+        if(!high){ \
+            bits = next_random(random); \
+            draw = (uint32_t)bits; \
+        } \
+        else{ \
+            draw = (uint32_t)(bits >> 32); \
+        } \
+        high = !high; \
+        colours[vertices[i]] = (unsigned char)(((uint64_t)draw * (uint64_t)(K)) >> 32); \
+    } \
+    return generate_result(graph, component, colours); \
+}
+
+DEFINE_POW2_KERNEL(2, 1)
+DEFINE_KERNEL(3, 3)
+DEFINE_POW2_KERNEL(4, 2)
+DEFINE_POW2_KERNEL(8, 3)
+DEFINE_KERNEL(generic, k)
+
+kernel_t select_kernel(int k){
+    switch(k){
+        case 2:
+            return kernel_2;
+        case 3:
+            return kernel_3;
+        case 4:
+            return kernel_4;
+        case 8:
+            return kernel_8;
+        default:
+            return kernel_generic;
+    }
+}
+
+/**
+  * Random Below function
+  * @brief Random number in [0, bound) from 32 random bits
+  * @param random the random generator
+  * @param bound the bound
+**/
+static inline int random_below(struct Random *random, int bound){
+    return (int)(((next_random(random) >> 32) * (uint64_t)bound) >> 32);
+}
+
+int count_conflicts(const struct Graph *graph, int component, const unsigned char *colours){
+    int conflicts = 0;
+    for(int i = graph->component_edges[component]; i < graph->component_edges[component + 1]; i++){
+        conflicts += colours[graph->edges[i].u] == colours[graph->edges[i].v];
+    }
+    return conflicts;
+}
+
+int init_local_search(struct LocalSearch *search, const struct Graph *graph){
+    int vertices = graph->vertex_count > 0 ? graph->vertex_count : 1;
+    search->capacity = 2 * vertices + 32;
+    search->queue = malloc(sizeof(int) * vertices);
+    search->queued = calloc(vertices, 1);
+    search->moved = malloc(sizeof(int) * search->capacity);
+    search->previous = malloc(search->capacity);
+    if(search->queue == NULL || search->queued == NULL || search->moved == NULL || search->previous == NULL){
+        free_local_search(search);
+        return -1;
+    }
+    return 0;
+}
+
+void free_local_search(struct LocalSearch *search){
+    free(search->queue);
+    free(search->queued);
+    free(search->moved);
+    free(search->previous);
+    search->queue = NULL;
+    search->queued = NULL;
+    search->moved = NULL;
+    search->previous = NULL;
+}
+
+/**
+  * Recolour function
+  * @brief Give a vertex a new colour and queue the neighbours it conflicts with now
+  * @details A self-loop conflicts with every colour, so it doesn't change the conflicts.
+  * @return the change of the conflicts
+**/
+static int recolour(const struct Graph *graph, unsigned char *colours, struct LocalSearch *search,
+    int *moves, int *tail, int v, int colour){
+    int delta = 0;
+    int vertices = graph->vertex_count;
+
+    search->moved[*moves] = v;
+    search->previous[*moves] = colours[v];
+    (*moves)++;
+
+    for(int j = graph->adjacency_offsets[v]; j < graph->adjacency_offsets[v + 1]; j++){
+        int w = graph->adjacency[j];
+        if(w == v){
+            continue;
+        }
+        delta -= colours[w] == colours[v];
+        if(colours[w] == colour){
+            delta++;
+            if(!search->queued[w]){
+                search->queued[w] = 1;
+                search->queue[*tail] = w;
+                *tail = (*tail + 1) % vertices;
+            }
+        }
+    }
+    colours[v] = (unsigned char)colour;
+    return delta;
+}
+
+int local_search(const struct Graph *graph, int component, unsigned char *colours, int conflicts,
+    struct LocalSearch *search, struct Random *random, int k){
+    const int *vertices = graph->component_vertices + graph->component_vertex_offsets[component];
+    int size = graph->component_vertex_offsets[component + 1] - graph->component_vertex_offsets[component];
+    int budget = size + 16;
+    unsigned int counts[MAX_COLOURS];
+    int moves = 0;
+    int head = 0;
+    int tail = 0;
+    int delta = 0;
+
+    //Leave the local minimum by recolouring a few random vertices
+    for(int perturb = 1 + size / 1024; perturb > 0; perturb--){
+        int v = vertices[random_below(random, size)];
+        int colour = (colours[v] + 1 + random_below(random, k - 1)) % k;
+        delta += recolour(graph, colours, search, &moves, &tail, v, colour);
+        if(!search->queued[v]){
+            search->queued[v] = 1;
+            search->queue[tail] = v;
+            tail = (tail + 1) % graph->vertex_count;
+        }
+    }
+
+    //Move the queued vertices with a conflict to the colour least used by their neighbours
+    while(head != tail){
+        int v = search->queue[head];
+        head = (head + 1) % graph->vertex_count;
+        search->queued[v] = 0;
+        if(budget == 0){
+            continue;
+        }
+
+        memset(counts, 0, sizeof(counts[0]) * k);
+        for(int j = graph->adjacency_offsets[v]; j < graph->adjacency_offsets[v + 1]; j++){
+            counts[colours[graph->adjacency[j]]] += graph->adjacency[j] != v;
+        }
+        if(counts[colours[v]] == 0){
+            continue;
+        }
+
+        //Ties are broken randomly, else the search keeps going back and forth
+        int first = random_below(random, k);
+        int best = colours[v];
+        for(int n = 0; n < k; n++){
+            int colour = (first + n) % k;
+            if(counts[colour] < counts[best]){
+                best = colour;
+            }
+        }
+        if(best != colours[v]){
+            delta += recolour(graph, colours, search, &moves, &tail, v, best);
+            budget--;
+        }
+    }
+
+    //Worse colourings are undone, equal ones are kept so the search moves along plateaus
+    if(delta > 0){
+        while(moves > 0){
+            moves--;
+            colours[search->moved[moves]] = search->previous[moves];
+        }
+        return conflicts;
+    }
+    return conflicts + delta;
+}
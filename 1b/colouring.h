@@ -0,0 +1,148 @@
+/**
+  * @file colouring.h
+  * @author
+  * @date 13.11.2022
+  * @brief The module containing the colouring kernels of the generators.
+  * @details A kernel colours the vertices of one component randomly with k colours
+  * and collects the edges whose nodes got the same colour. There are kernels
+  * specialized for 2, 3, 4 and 8 colours and a generic one for every other k.
+  * A warm started generator improves a colouring with local search instead.
+**/
+#include <stdint.h>
+
+#include "circularBuffer.h"
+#include "graph.h"
+
+
+#ifndef COLOURING_H
+#define COLOURING_H
+
+
+#define MIN_COLOURS (2)
+#define MAX_COLOURS (64)
+
+
+/**
+  * Structure for the random generator
+  * @brief State of a xorshift64* generator
+  * @details Every generator has its own, which is much cheaper than rand().
+**/
+struct Random{
+    uint64_t state;
+};
+
+/**
+  * Structure for the local search
+  * @brief The working memory of the local search
+  * @details queue holds the vertices to repair, each at most once as marked in queued.
+  * moved and previous log the moves of an attempt, so it can be undone.
+**/
+struct LocalSearch{
+    int *queue;
+    unsigned char *queued;
+    int *moved;
+    unsigned char *previous;
+    int capacity;
+};
+
+/**
+  * Kernel type
+  * @brief Colour a component and collect the removed edges
+  * @param graph the input graph
+  * @param component the component to colour
+  * @param colours colour of every vertex, only the vertices of the component are written
+  * @param random the random generator
+  * @param k number of colours, only used by the generic kernel
+  * @return result containg the amount of edges removed and the removed edges
+**/
+typedef struct Result (*kernel_t)(const struct Graph *graph, int component, unsigned char *colours,
+    struct Random *random, int k);
+
+
+/**
+  * Next Random function
+  * @brief Next 64 random bits of a xorshift64* generator
+  * @param random the generator
+  * @details Inline, the kernels draw in their innermost loop.
+  * @return the bits
+**/
+static inline uint64_t next_random(struct Random *random){
+    random->state ^= random->state >> 12;
+    random->state ^= random->state << 25;
+    random->state ^= random->state >> 27;
+    return random->state * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+  * Seed Random function
+  * @brief Seed a random generator
+  * @param random the generator
+  * @param seed any value, 0 included
+**/
+void seed_random(struct Random *random, uint64_t seed);
+
+/**
+  * Select Kernel function
+  * @brief The kernel for k colours
+  * @param k number of colours, MIN_COLOURS up to MAX_COLOURS
+  * @return the specialized kernel if there is one, else the generic kernel
+**/
+kernel_t select_kernel(int k);
+
+/**
+  * Count Conflicts function
+  * @brief Number of edges of a component whose vertices have the same colour
+  * @param graph the input graph
+  * @param component the component
+  * @param colours colour of every vertex
+  * @return the number of edges, not limited to MAX_EDGES
+**/
+int count_conflicts(const struct Graph *graph, int component, const unsigned char *colours);
+
+/**
+  * Init Local Search function
+  * @brief Allocate the working memory of the local search
+  * @param search the working memory
+  * @param graph the input graph
+  * @return 0 on success, -1 on failure
+**/
+int init_local_search(struct LocalSearch *search, const struct Graph *graph);
+
+/**
+  * Free Local Search function
+  * @brief Free the working memory of the local search
+  * @param search the working memory
+**/
+void free_local_search(struct LocalSearch *search);
+
+/**
+  * Local Search function
+  * @brief Try to improve the colouring of a component
+  * @details Recolours a few random vertices and then moves every vertex which got
+  * a conflict to the colour least used by its neighbours. If the colouring got
+  * worse, the moves are undone.
+  * @param graph the input graph
+  * @param component the component
+  * @param colours colour of every vertex, the current colouring of the search
+  * @param conflicts conflicts of the component in colours
+  * @param search the working memory
+  * @param random the random generator
+  * @param k number of colours
+  * @return the conflicts of the component afterwards
+**/
+int local_search(const struct Graph *graph, int component, unsigned char *colours, int conflicts,
+    struct LocalSearch *search, struct Random *random, int k);
+
+/**
+  * Generate Result function
+  * @brief Use for generating results
+  * @details Generate result by removing the neigbouring nodes with
+  * the same colour.
+  * @param graph the input graph
+  * @param component the component the colouring is for
+  * @param colours colour of every vertex
+  * @return result containg the amount of edges removed and the removed edges
+**/
+struct Result generate_result(const struct Graph *graph, int component, const unsigned char *colours);
+
+#endif
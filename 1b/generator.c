@@ -4,16 +4,42 @@
   * @date 13.11.2022
 
   * @brief The generator module
-  * @details A generator writes the result using the 3 colouring algorithm to the shared memory
+  * @details A generator writes the result using the k colouring algorithm to the shared memory.
+  * The number of colours is chosen by the supervisor, 3 by default.
+  * The graph is either given as edges or attached from the supervisor's shared graph.
+  * Every connected component is coloured on its own.
+  * A generator given a checkpoint improves the colouring from it with local search.
 **/
 #include "circularBuffer.h"
+#include "graph.h"
+#include "colouring.h"
+#include "solution.h"
 #include <stdbool.h>
 #include <stdio.h>
 #include <time.h>
 #include <limits.h>
+#include <unistd.h>
+#include <errno.h>
 
 char *progname;
 
+//True if the graph is the one published by the supervisor
+bool sharedGraph = false;
+
+/**
+  * Structure for the schedule
+  * @brief The components a generator works on
+  * @details own holds the components assigned to this generator, all every component.
+  * Solved components are dropped from the lists when they come up.
+**/
+struct Schedule{
+    int *own;
+    int ownCount;
+    int *all;
+    int allCount;
+    int position;
+};
+
 /**
   * Usage function
   * @brief explains how to use the programm
@@ -21,107 +47,175 @@ char *progname;
   * exit on EXIT_FAILURE
 **/
 void usage(void){
-    fprintf(stderr, "Usage: %s requires at least one edge where an edge is in form [d-d] where d is a number.\n", progname);
+    fprintf(stderr, "Usage: %s [-I ID] [-w FILE] [EDGE...] where an edge is in form [d-d] and d is a number.\n"
+        "Without edges the graph published by the supervisor is used.\n"
+        "-I ID attaches to the supervisor of instance ID.\n"
+        "-w FILE warm-starts a local search from the checkpoint FILE.\n", progname);
     exit(EXIT_FAILURE);
 }
 
 /**
-  * Is Node Aleady Coloured function
-  * @brief check if the parsed node is already coloured
-  * @details Checking if the node is already coloured helps with not assigning different
-  * colour values to the same node. 
-  * @param node Node to be checked
-  * @param parsedEdges Edge array containing the parsed edges and their nodes
-  * @param size size of the array
-  * @return the colour of the node or -1 indicating that node is still not coloured
+  * Component Best function
+  * @brief The best amount the supervisor has for a component
+  * @details For a graph from the command line the supervisor only knows the overall best.
+  * @param graph the input graph
+  * @param component the component
+  * @return the amount, INT_MAX if there is none yet
 **/
-int isNodeAlreadyColoured(struct Node node, struct Edge *parseEdges, int size){
-    
-    for(int i = 0; i <= size; i++){
-       
-        if(parseEdges[i].n1.value == node.value){
-            return parseEdges[i].n1.colour;
-        }
+int component_best(const struct Graph *graph, int component){
+    if(!sharedGraph){
+        return get_best();
+    }
+    return __atomic_load_n(&graph->component_best[component], __ATOMIC_RELAXED);
+}
+
+/**
+  * Init Schedule function
+  * @brief Assign components to this generator
+  * @details With G generators started by the supervisor, generator slot s owns
+  * the components c with c % G == s % G, so every component gets its own subset
+  * of generators. Generators started by hand own every component.
+  * @param graph the input graph
+  * @param schedule the schedule
+**/
+void init_schedule(const struct Graph *graph, struct Schedule *schedule){
+    int count = graph->component_count;
+    int generators = get_generator_count();
+    int slot = generator_slot();
+
+    schedule->own = malloc(sizeof(int) * count);
+    schedule->all = malloc(sizeof(int) * count);
+    if(schedule->own == NULL || schedule->all == NULL){
+        failed_exit("Malloc failed. \n");
+    }
+
+    if(generators <= 0 || slot < 0){
+        generators = 1;
+        slot = 0;
+    }
 
-        if(parseEdges[i].n2.value == node.value){
-            return parseEdges[i].n2.colour;
+    schedule->ownCount = 0;
+    schedule->allCount = count;
+    for(int c = 0; c < count; c++){
+        schedule->all[c] = c;
+        if(c % generators == slot % generators){
+            schedule->own[schedule->ownCount++] = c;
         }
     }
+    schedule->position = 0;
+}
 
+/**
+  * Next Unsolved function
+  * @brief Take the next unsolved component from a list
+  * @param graph the input graph
+  * @param list the components
+  * @param count number of components in the list, solved ones are removed
+  * @param position position in the list
+  * @return the component, -1 if all are solved
+**/
+int next_unsolved(const struct Graph *graph, int *list, int *count, int *position){
+    while(*count > 0){
+        *position = (*position + 1) % *count;
+        int component = list[*position];
+        if(component_best(graph, component) != 0){
+            return component;
+        }
+        list[*position] = list[--(*count)];
+    }
     return -1;
 }
 
 /**
-  * Colour Node function
-  * @brief colours the node
-  * @param node Node to be coloured
+  * Next Component function
+  * @brief Choose the component for the next attempt
+  * @details Goes round robin through the own unsolved components. When all of
+  * them are solved the generator helps with the other components.
+  * @param graph the input graph
+  * @param schedule the schedule
+  * @return the component, -1 if every component is solved
 **/
-void colour_node(struct Node *node){
-    node->colour = (rand() % (3));
+int next_component(const struct Graph *graph, struct Schedule *schedule){
+    int component = next_unsolved(graph, schedule->own, &schedule->ownCount, &schedule->position);
+    if(component == -1){
+        component = next_unsolved(graph, schedule->all, &schedule->allCount, &schedule->position);
+    }
+    return component;
 }
 
 /**
-  * Parse Graph function
-  * @brief Parses the input graph
-  * @details Parses the input graph and if the input isn't in the form of d-d,
-  * prints usage and exit on EXIT_FAILURE. Else colour the node and save 
-  * it to the parsedEdge array.
-  * @param edge Edge of the input graph
-  * @param parsedEdges Array to store edges
-  * @param size size of the graph
+  * Load Graph function
+  * @brief Load the graph to colour
+  * @details With edges on the command line the graph is built from them,
+  * else the generator attaches to the graph published by the supervisor.
+  * @param count number of edges
+  * @param edges the edges from the command line
+  * @param graph the loaded graph
 **/
-void parse_graph(char *edge, struct Edge *parseEdges, int size){
-    struct Node node1;
-    struct Node node2;
-    
-    if (sscanf(edge, "%d-%d", &node1.value, &node2.value) != 2){
-			usage();
-	}
-
-   if((node1.colour = isNodeAlreadyColoured(node1, parseEdges, size)) == -1){
-        colour_node(&node1);
+void load_graph(int count, char **edges, struct Graph *graph){
+    if(count == 0){
+        if(open_shared_graph(graph) == -1){
+            fprintf(stderr, "%s: no edges given and the supervisor didn't publish a graph.\n", progname);
+            usage();
+        }
+        sharedGraph = true;
+        return;
     }
 
-    if((node2.colour = isNodeAlreadyColoured(node2, parseEdges, size)) == -1){
-        colour_node(&node2);
+    struct RawGraph raw;
+    if(load_graph_arguments(edges, count, &raw) == -1){
+        usage();
+    }
+    if(prepare_graph(&raw) == -1){
+        failed_exit("Couldn't prepare the graph. \n");
     }
 
-    parseEdges[size].n1 = node1;
-    parseEdges[size].n2 = node2;
-
+    void *memory = malloc(graph_segment_size(&raw));
+    if(memory == NULL){
+        failed_exit("Malloc failed. \n");
+    }
+    layout_graph(memory, &raw);
+    attach_graph(memory, graph);
+    free_raw_graph(&raw);
 }
 
 /**
-  * Generate Result function
-  * @brief Use for generating results
-  * @details Generate result by removing the neigbouring nodes with
-  * the same colour.
-  * @param parsedEdges the edges from the input graph
-  * @param graphSize size of the graph = number of edges
-  * @return result containg the amount of edges removed and the removed edges
+  * Warm Start function
+  * @brief Load the colouring the local search starts from
+  * @details Vertices which aren't in the checkpoint get a random colour. Without
+  * the checkpoint file the search starts from a random colouring.
+  * @param path path of the checkpoint
+  * @param graph the input graph
+  * @param colours the colouring is stored here
+  * @param conflicts conflicts of every component of the colouring
+  * @param random the random generator
+  * @param k number of colours
 **/
-struct Result generate_result(struct Edge *parsedEdges, int graphSize){
-    struct Result result;
-    int removedEdges = 0;
-    for(int i = 0; i < graphSize; i++){
-        if(removedEdges >= MAX_EDGES){
-            result.amount = INT_MAX;
-            return result;
-        }
-        if(parsedEdges[i].n1.colour == parsedEdges[i].n2.colour){
-            result.edges[removedEdges] = parsedEdges[i];
-            removedEdges++;
+void warm_start(const char *path, const struct Graph *graph, unsigned char *colours, int *conflicts,
+    struct Random *random, int k){
+    kernel_t kernel = select_kernel(k);
+    for(int c = 0; c < graph->component_count; c++){
+        kernel(graph, c, colours, random, k);
+    }
+
+    if(load_checkpoint(path, graph, colours, k) == -1){
+        if(errno != ENOENT){
+            fprintf(stderr, "%s: %s is not a checkpoint of this graph.\n", progname, path);
+            close_buffer(false);
+            exit(EXIT_FAILURE);
         }
+        fprintf(stderr, "%s: no checkpoint %s yet, starting from a random colouring.\n", progname, path);
     }
 
-    result.amount = removedEdges;
-    return result;
+    for(int c = 0; c < graph->component_count; c++){
+        conflicts[c] = count_conflicts(graph, c, colours);
+    }
 }
 
 /**
   * Main function
   * @brief entry point to the program
-  * @details A generator produces results using the 3 colouring algorithm.
+  * @details A generator produces results using the k colouring algorithm.
   * These results are then written to the shared circular buffer. 
   * @param argc
   * @param argv
@@ -131,38 +225,111 @@ int main(int argc, char **argv){
    
     progname = argv[0];
 
-    if(argc < 2){
-        usage();
-    }
-    
     bool isSupervisor = false;
-  
-    int graphSize = argc-1;
-    struct Edge *savedEdges = malloc(sizeof(struct Edge) * graphSize);
+    bool hasInstance = false;
+    char *checkpoint = NULL;
+    int c = 0;
+
+    while((c = getopt(argc, argv, "I:w:")) != -1){
+        switch (c){
+            case 'I':
+                if(hasInstance || set_instance(optarg) == -1){
+                    usage();
+                }
+                hasInstance = true;
+                break;
+            case 'w':
+                if(checkpoint != NULL){
+                    usage();
+                }
+                checkpoint = optarg;
+                break;
+            default:
+                usage();
+                break;
+        }
+    }
+
+    struct Graph graph;
+    load_graph(argc - optind, argv + optind, &graph);
+
+    unsigned char *colours = malloc(graph.vertex_count);
+    if(colours == NULL){
+        failed_exit("Malloc failed. \n");
+    }
     
     //For different colouring of the graph
-    srand(time(0));
-    for(int i = 1; i <= graphSize; i++){
-      
-        parse_graph(argv[i],savedEdges, i-1);
-    }
+    struct Random random;
+    seed_random(&random, ((uint64_t)time(0) << 32) ^ (uint64_t)getpid());
     
     open_buffer(isSupervisor);
 
+    int k = get_colours();
+    kernel_t kernel = select_kernel(k);
+
+    //The supervisor saves the colourings of the shared graph
+    if(sharedGraph && open_solution(&graph) == -1){
+        fprintf(stderr, "%s: the supervisor has no solution segment, colourings aren't saved.\n", progname);
+    }
+
+    //With local search colours is the current colouring and conflicts has its conflicts in every component
+    struct LocalSearch search;
+    int *conflicts = NULL;
+    if(checkpoint != NULL){
+        conflicts = malloc(sizeof(int) * graph.component_count);
+        if(conflicts == NULL || init_local_search(&search, &graph) == -1){
+            close_buffer(isSupervisor);
+            failed_exit("Malloc failed. \n");
+        }
+        warm_start(checkpoint, &graph, colours, conflicts, &random, k);
+    }
+
+    struct Schedule schedule;
+    init_schedule(&graph, &schedule);
+
+    struct timespec idle = {.tv_sec = 0, .tv_nsec = 1000 * 1000};
+
     while(get_state() == false){
-       
-        struct Result result = generate_result(savedEdges, graphSize);
-       
-        savedEdges = NULL;
-        savedEdges = malloc(sizeof(struct Edge) * graphSize);
-        for(int i = 1; i <= graphSize; i++){
-            parse_graph(argv[i],savedEdges, i-1);
+        int component = next_component(&graph, &schedule);
+        if(component == -1){
+            //Everything is solved, the supervisor stops us soon
+            nanosleep(&idle, NULL);
+            continue;
         }
-       
+
+        struct Result result;
+        if(conflicts != NULL){
+            conflicts[component] = local_search(&graph, component, colours, conflicts[component], &search, &random, k);
+            STAT_ADD(generator_stats->attempts, 1);
+
+            if(conflicts[component] > MAX_EDGES){
+                STAT_ADD(generator_stats->filtered, 1);
+                continue;
+            }
+            result = generate_result(&graph, component, colours);
+        }
+        else{
+            result = kernel(&graph, component, colours, &random, k);
+            STAT_ADD(generator_stats->attempts, 1);
+        }
+
+        //Only results which improve the best one are worth the buffer
+        if(result.amount >= component_best(&graph, component)){
+            STAT_ADD(generator_stats->filtered, 1);
+            continue;
+        }
+        //The colouring has to be there before the supervisor reads the result
+        offer_solution(&graph, component, colours, result.amount);
         write_to_buffer(&result);
     } 
 
-    free(savedEdges);
+    free(schedule.own);
+    free(schedule.all);
+    free(colours);
+    if(conflicts != NULL){
+        free_local_search(&search);
+        free(conflicts);
+    }
     clean_exit(isSupervisor);
 
 }
\ No newline at end of file
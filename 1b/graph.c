@@ -0,0 +1,575 @@
+/**
+  * @file graph.c
+  * @author
+  * @date 13.11.2022
+  * @brief Implementation of graph.h
+**/
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <errno.h>
+
+#include "graph.h"
+#include "circularBuffer.h"
+
+//Mapped graph segment
+static void *graph_memory = NULL;
+static size_t graph_size = 0;
+
+
+/**
+  * Parse Number function
+  * @brief Parse a non-negative node value
+  * @param pos position in the line, moved behind the number
+  * @param value the parsed value
+  * @return 0 on success, -1 if there is no number or it is too large
+**/
+static int parse_number(const char **pos, int *value){
+    const char *p = *pos;
+    long number = 0;
+
+    if(!isdigit((unsigned char)*p)){
+        return -1;
+    }
+
+    while(isdigit((unsigned char)*p)){
+        number = number * 10 + (*p - '0');
+        if(number > INT_MAX){
+            return -1;
+        }
+        p++;
+    }
+
+    *value = (int)number;
+    *pos = p;
+    return 0;
+}
+
+/**
+  * Parse Edge function
+  * @brief Parse an edge in the form "u v" or "u-v"
+  * @param text the text of the edge
+  * @param edge the parsed edge
+  * @return 0 on success, -1 if the text is not an edge
+**/
+static int parse_edge(const char *text, struct GraphEdge *edge){
+    const char *p = text;
+
+    while(*p == ' ' || *p == '\t'){
+        p++;
+    }
+    if(parse_number(&p, &edge->u) == -1){
+        return -1;
+    }
+
+    while(*p == ' ' || *p == '\t'){
+        p++;
+    }
+    if(*p == '-'){
+        p++;
+    }
+    while(*p == ' ' || *p == '\t'){
+        p++;
+    }
+    if(parse_number(&p, &edge->v) == -1){
+        return -1;
+    }
+
+    while(isspace((unsigned char)*p)){
+        p++;
+    }
+    return *p == '\0' ? 0 : -1;
+}
+
+/**
+  * Append Edge function
+  * @brief Append an edge to a raw graph
+  * @param raw the graph
+  * @param capacity allocated number of edges, grows if needed
+  * @param edge the edge to append
+  * @return 0 on success, -1 if no memory is left
+**/
+static int append_edge(struct RawGraph *raw, size_t *capacity, struct GraphEdge edge){
+    if((size_t)raw->edge_count == *capacity){
+        size_t newCapacity = *capacity == 0 ? 1024 : *capacity * 2;
+        struct GraphEdge *edges = realloc(raw->edges, newCapacity * sizeof(*edges));
+        if(edges == NULL){
+            return -1;
+        }
+        raw->edges = edges;
+        *capacity = newCapacity;
+    }
+
+    if(raw->edge_count >= INT_MAX / 2){
+        return -1;
+    }
+
+    raw->edges[raw->edge_count++] = edge;
+    return 0;
+}
+
+int load_graph_file(const char *path, struct RawGraph *raw){
+    FILE *file = fopen(path, "r");
+    if(file == NULL){
+        fprintf(stderr, "Couldn't open graph file %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    memset(raw, 0, sizeof(*raw));
+    size_t capacity = 0;
+
+    char *line = NULL;
+    size_t length = 0;
+    long lineNumber = 0;
+    int ret = 0;
+
+    while(getline(&line, &length, file) != -1){
+        lineNumber++;
+        const char *p = line;
+        while(*p == ' ' || *p == '\t'){
+            p++;
+        }
+
+        //Comments, DIMACS problem line and empty lines
+        if(*p == 'c' || *p == '#' || *p == '%' || *p == 'p' || *p == '\n' || *p == '\0'){
+            continue;
+        }
+
+        //DIMACS edge
+        if(*p == 'e'){
+            p++;
+        }
+
+        struct GraphEdge edge;
+        if(parse_edge(p, &edge) == -1){
+            fprintf(stderr, "%s:%ld: not an edge\n", path, lineNumber);
+            ret = -1;
+            break;
+        }
+
+        if(append_edge(raw, &capacity, edge) == -1){
+            fprintf(stderr, "%s: too many edges\n", path);
+            ret = -1;
+            break;
+        }
+    }
+
+    free(line);
+    fclose(file);
+
+    if(ret == 0 && raw->edge_count == 0){
+        fprintf(stderr, "%s: the graph has no edges\n", path);
+        ret = -1;
+    }
+    if(ret == -1){
+        free_raw_graph(raw);
+    }
+    return ret;
+}
+
+int load_graph_arguments(char **args, int count, struct RawGraph *raw){
+    memset(raw, 0, sizeof(*raw));
+    size_t capacity = 0;
+
+    for(int i = 0; i < count; i++){
+        struct GraphEdge edge;
+        if(strchr(args[i], '-') == NULL || parse_edge(args[i], &edge) == -1
+            || append_edge(raw, &capacity, edge) == -1){
+            free_raw_graph(raw);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+  * Compare Int function
+  * @brief Compare function for qsort and bsearch
+**/
+static int compare_int(const void *a, const void *b){
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+  * Compare Edge function
+  * @brief Compare function for qsort, orders edges by u and then v
+**/
+static int compare_edge(const void *a, const void *b){
+    const struct GraphEdge *x = a;
+    const struct GraphEdge *y = b;
+    if(x->u != y->u){
+        return (x->u > y->u) - (x->u < y->u);
+    }
+    return (x->v > y->v) - (x->v < y->v);
+}
+
+/**
+  * Vertex Index function
+  * @brief Look up the vertex index of a node value
+  * @param raw the graph with sorted labels
+  * @param value the node value
+  * @return the index
+**/
+static int vertex_index(const struct RawGraph *raw, int value){
+    const int *found = bsearch(&value, raw->labels, raw->vertex_count, sizeof(int), compare_int);
+    return (int)(found - raw->labels);
+}
+
+int prepare_graph(struct RawGraph *raw){
+    raw->labels = malloc(sizeof(int) * 2 * raw->edge_count);
+    if(raw->labels == NULL){
+        return -1;
+    }
+
+    for(int i = 0; i < raw->edge_count; i++){
+        raw->labels[2 * i] = raw->edges[i].u;
+        raw->labels[2 * i + 1] = raw->edges[i].v;
+    }
+    qsort(raw->labels, 2 * raw->edge_count, sizeof(int), compare_int);
+
+    int distinct = 0;
+    for(int i = 0; i < 2 * raw->edge_count; i++){
+        if(distinct == 0 || raw->labels[distinct - 1] != raw->labels[i]){
+            raw->labels[distinct++] = raw->labels[i];
+        }
+    }
+    raw->vertex_count = distinct;
+
+    //Both directions of an edge become u < v, so sorting puts duplicates next to each other
+    for(int i = 0; i < raw->edge_count; i++){
+        int u = vertex_index(raw, raw->edges[i].u);
+        int v = vertex_index(raw, raw->edges[i].v);
+        raw->edges[i].u = u < v ? u : v;
+        raw->edges[i].v = u < v ? v : u;
+    }
+    qsort(raw->edges, raw->edge_count, sizeof(struct GraphEdge), compare_edge);
+
+    int unique = 0;
+    for(int i = 0; i < raw->edge_count; i++){
+        if(unique == 0 || compare_edge(&raw->edges[unique - 1], &raw->edges[i]) != 0){
+            raw->edges[unique++] = raw->edges[i];
+        }
+    }
+    raw->edge_count = unique;
+    return 0;
+}
+
+/**
+  * Find Root function
+  * @brief Find the root of a vertex in the union-find forest
+  * @details Halves the path on the way up.
+  * @param parent parent of every vertex
+  * @param v the vertex
+  * @return the root
+**/
+static int find_root(int *parent, int v){
+    while(parent[v] != v){
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+int split_components(struct RawGraph *raw){
+    int *parent = malloc(sizeof(int) * raw->vertex_count);
+    int *size = malloc(sizeof(int) * raw->vertex_count);
+    if(parent == NULL || size == NULL){
+        free(parent);
+        free(size);
+        return -1;
+    }
+
+    for(int v = 0; v < raw->vertex_count; v++){
+        parent[v] = v;
+        size[v] = 1;
+    }
+
+    //Union by size
+    for(int i = 0; i < raw->edge_count; i++){
+        int a = find_root(parent, raw->edges[i].u);
+        int b = find_root(parent, raw->edges[i].v);
+        if(a == b){
+            continue;
+        }
+        if(size[a] < size[b]){
+            int tmp = a;
+            a = b;
+            b = tmp;
+        }
+        parent[b] = a;
+        size[a] += size[b];
+    }
+
+    //Point every vertex at its root, then number the roots reusing size
+    for(int v = 0; v < raw->vertex_count; v++){
+        parent[v] = find_root(parent, v);
+    }
+    int count = 0;
+    for(int v = 0; v < raw->vertex_count; v++){
+        if(parent[v] == v){
+            size[v] = count++;
+        }
+    }
+    for(int v = 0; v < raw->vertex_count; v++){
+        parent[v] = size[parent[v]];
+    }
+
+    free(size);
+    free(raw->components);
+    raw->components = parent;
+    raw->component_count = count;
+    return 0;
+}
+
+void free_raw_graph(struct RawGraph *raw){
+    free(raw->edges);
+    free(raw->labels);
+    free(raw->components);
+    memset(raw, 0, sizeof(*raw));
+}
+
+/**
+  * Align function
+  * @brief Round an offset up to 8 bytes
+**/
+static size_t align(size_t offset){
+    return (offset + 7) & ~(size_t)7;
+}
+
+/**
+  * Compute Layout function
+  * @brief Compute the offsets of the arrays in a graph segment
+  * @param raw the prepared graph
+  * @param header the offsets and the total size are stored here
+**/
+static void compute_layout(const struct RawGraph *raw, struct GraphHeader *header){
+    size_t offset = align(sizeof(struct GraphHeader));
+
+    header->vertex_count = raw->vertex_count;
+    header->edge_count = raw->edge_count;
+
+    header->labels_offset = offset;
+    offset = align(offset + sizeof(int) * raw->vertex_count);
+
+    header->edges_offset = offset;
+    offset = align(offset + sizeof(struct GraphEdge) * raw->edge_count);
+
+    header->adjacency_offsets_offset = offset;
+    offset = align(offset + sizeof(int) * (raw->vertex_count + 1));
+
+    header->adjacency_offset = offset;
+    offset = align(offset + sizeof(int) * 2 * raw->edge_count);
+
+    header->component_count = raw->component_count > 0 ? raw->component_count : 1;
+
+    header->component_edges_offset = offset;
+    offset = align(offset + sizeof(int) * (header->component_count + 1));
+
+    header->component_vertex_offsets_offset = offset;
+    offset = align(offset + sizeof(int) * (header->component_count + 1));
+
+    header->component_vertices_offset = offset;
+    offset = align(offset + sizeof(int) * raw->vertex_count);
+
+    header->component_best_offset = offset;
+    offset = align(offset + sizeof(int) * header->component_count);
+
+    header->size = offset;
+}
+
+size_t graph_segment_size(const struct RawGraph *raw){
+    struct GraphHeader header;
+    compute_layout(raw, &header);
+    return header.size;
+}
+
+/**
+  * Component Of function
+  * @brief Component of a vertex
+  * @details Without split_components the whole graph is component 0.
+**/
+static int component_of(const struct RawGraph *raw, int v){
+    return raw->components != NULL ? raw->components[v] : 0;
+}
+
+void layout_graph(void *memory, const struct RawGraph *raw){
+    struct GraphHeader *header = memory;
+    compute_layout(raw, header);
+
+    //The size marks the segment as complete, it is only stored once everything is written
+    size_t size = header->size;
+    header->size = 0;
+
+    char *base = memory;
+    int *labels = (int *)(base + header->labels_offset);
+    struct GraphEdge *edges = (struct GraphEdge *)(base + header->edges_offset);
+    int *offsets = (int *)(base + header->adjacency_offsets_offset);
+    int *adjacency = (int *)(base + header->adjacency_offset);
+
+    int components = header->component_count;
+    int *componentEdges = (int *)(base + header->component_edges_offset);
+    int *vertexOffsets = (int *)(base + header->component_vertex_offsets_offset);
+    int *vertices = (int *)(base + header->component_vertices_offset);
+    int *best = (int *)(base + header->component_best_offset);
+
+    memcpy(labels, raw->labels, sizeof(int) * raw->vertex_count);
+
+    //Group edges and vertices by component, the same way as the adjacency below
+    memset(componentEdges, 0, sizeof(int) * (components + 1));
+    memset(vertexOffsets, 0, sizeof(int) * (components + 1));
+    for(int i = 0; i < raw->edge_count; i++){
+        componentEdges[component_of(raw, raw->edges[i].u) + 1]++;
+    }
+    for(int v = 0; v < raw->vertex_count; v++){
+        vertexOffsets[component_of(raw, v) + 1]++;
+    }
+    for(int c = 0; c < components; c++){
+        componentEdges[c + 1] += componentEdges[c];
+        vertexOffsets[c + 1] += vertexOffsets[c];
+    }
+    for(int i = 0; i < raw->edge_count; i++){
+        edges[componentEdges[component_of(raw, raw->edges[i].u)]++] = raw->edges[i];
+    }
+    for(int v = 0; v < raw->vertex_count; v++){
+        vertices[vertexOffsets[component_of(raw, v)]++] = v;
+    }
+    for(int c = components; c > 0; c--){
+        componentEdges[c] = componentEdges[c - 1];
+        vertexOffsets[c] = vertexOffsets[c - 1];
+    }
+    componentEdges[0] = 0;
+    vertexOffsets[0] = 0;
+
+    for(int c = 0; c < components; c++){
+        best[c] = INT_MAX;
+    }
+
+    //Degrees, then the start of every vertex
+    memset(offsets, 0, sizeof(int) * (raw->vertex_count + 1));
+    for(int i = 0; i < raw->edge_count; i++){
+        offsets[edges[i].u + 1]++;
+        offsets[edges[i].v + 1]++;
+    }
+    for(int v = 0; v < raw->vertex_count; v++){
+        offsets[v + 1] += offsets[v];
+    }
+
+    //Fill using offsets[v] as cursor, which shifts every start to the next vertex
+    for(int i = 0; i < raw->edge_count; i++){
+        adjacency[offsets[edges[i].u]++] = edges[i].v;
+        adjacency[offsets[edges[i].v]++] = edges[i].u;
+    }
+    for(int v = raw->vertex_count; v > 0; v--){
+        offsets[v] = offsets[v - 1];
+    }
+    offsets[0] = 0;
+
+    __atomic_store_n(&header->size, size, __ATOMIC_RELEASE);
+}
+
+void attach_graph(const void *memory, struct Graph *graph){
+    const char *base = memory;
+    graph->header = memory;
+    graph->vertex_count = graph->header->vertex_count;
+    graph->edge_count = graph->header->edge_count;
+    graph->labels = (const int *)(base + graph->header->labels_offset);
+    graph->edges = (const struct GraphEdge *)(base + graph->header->edges_offset);
+    graph->adjacency_offsets = (const int *)(base + graph->header->adjacency_offsets_offset);
+    graph->adjacency = (const int *)(base + graph->header->adjacency_offset);
+    graph->component_count = graph->header->component_count;
+    graph->component_edges = (const int *)(base + graph->header->component_edges_offset);
+    graph->component_vertex_offsets = (const int *)(base + graph->header->component_vertex_offsets_offset);
+    graph->component_vertices = (const int *)(base + graph->header->component_vertices_offset);
+    graph->component_best = (int *)(base + graph->header->component_best_offset);
+}
+
+int publish_graph(const struct RawGraph *raw, struct Graph *graph){
+    size_t size = graph_segment_size(raw);
+    char name[MAX_NAME];
+    instance_name(name, SHM_GRAPH);
+
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(fd == -1){
+        return -1;
+    }
+
+    if(ftruncate(fd, size) < 0){
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+
+    void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(memory == MAP_FAILED){
+        shm_unlink(name);
+        return -1;
+    }
+    //Only the whole huge pages of the segment can use them
+    advise_huge_pages(memory, size);
+
+    layout_graph(memory, raw);
+
+    graph_memory = memory;
+    graph_size = size;
+    attach_graph(memory, graph);
+    return 0;
+}
+
+int open_shared_graph(struct Graph *graph){
+    char name[MAX_NAME];
+    instance_name(name, SHM_GRAPH);
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if(fd == -1){
+        return -1;
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(struct GraphHeader)){
+        close(fd);
+        return -1;
+    }
+
+    void *memory = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(memory == MAP_FAILED){
+        return -1;
+    }
+
+    //A segment still being laid out has size 0
+    if(__atomic_load_n(&((const struct GraphHeader *)memory)->size, __ATOMIC_ACQUIRE) != (size_t)st.st_size){
+        munmap(memory, st.st_size);
+        return -1;
+    }
+
+    graph_memory = memory;
+    graph_size = st.st_size;
+    attach_graph(memory, graph);
+    return 0;
+}
+
+void close_graph(bool isSupervisor){
+    if(graph_memory == NULL){
+        return;
+    }
+
+    munmap(graph_memory, graph_size);
+    graph_memory = NULL;
+    graph_size = 0;
+
+    if(isSupervisor){
+        char name[MAX_NAME];
+        instance_name(name, SHM_GRAPH);
+        shm_unlink(name);
+    }
+}
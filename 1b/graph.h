@@ -0,0 +1,200 @@
+/**
+  * @file graph.h
+  * @author
+  * @date 13.11.2022
+  * @brief The module for loading a graph once and sharing it with the generators.
+  * @details The supervisor parses an edge list or DIMACS file, builds the adjacency
+  * and places it in a shared memory object. Generators attach to the prebuilt graph
+  * read-only and don't parse anything. Small graphs can still be given as [d-d] arguments.
+  * The graph is split into its connected components, which are solved independently.
+**/
+#include <stdbool.h>
+#include <stddef.h>
+
+
+#ifndef GRAPH_H
+#define GRAPH_H
+
+
+//Object name, see instance_name in circularBuffer.h
+#define SHM_GRAPH "graph"
+
+
+/**
+  * Structure for the graph edge
+  * @brief An edge between two vertices
+  * @details Before the graph is prepared u and v are the node values from the input,
+  * afterwards they are indices into the labels array.
+**/
+struct GraphEdge{
+    int u;
+    int v;
+};
+
+/**
+  * Structure for the raw graph
+  * @brief The graph as it comes from the input
+  * @details Holds the edges and, after prepare_graph, the sorted distinct node values.
+  * After split_components, components holds the component of every vertex.
+  * Without it the whole graph is one component.
+**/
+struct RawGraph{
+    struct GraphEdge *edges;
+    int edge_count;
+    int *labels;
+    int vertex_count;
+    int *components;
+    int component_count;
+};
+
+/**
+  * Structure for the graph header
+  * @brief The header at the start of a graph segment
+  * @details Everything behind the header is addressed by offsets, so the segment
+  * can be mapped at a different address in every process.
+**/
+struct GraphHeader{
+    size_t size;
+    int vertex_count;
+    int edge_count;
+    size_t labels_offset;
+    size_t edges_offset;
+    size_t adjacency_offsets_offset;
+    size_t adjacency_offset;
+    int component_count;
+    size_t component_edges_offset;
+    size_t component_vertex_offsets_offset;
+    size_t component_vertices_offset;
+    size_t component_best_offset;
+};
+
+/**
+  * Structure for the graph
+  * @brief The view of a graph segment
+  * @details The neighbours of vertex v are adjacency[adjacency_offsets[v]] up to
+  * adjacency[adjacency_offsets[v+1]-1]. labels[v] is the node value of vertex v.
+  * The edges are grouped by component: component c has the edges component_edges[c]
+  * up to component_edges[c+1]-1 and the vertices listed in component_vertices from
+  * component_vertex_offsets[c] up to component_vertex_offsets[c+1]-1.
+  * component_best is the best amount the supervisor read for every component,
+  * it may only be written through the supervisor's mapping.
+**/
+struct Graph{
+    const struct GraphHeader *header;
+    int vertex_count;
+    int edge_count;
+    const int *labels;
+    const struct GraphEdge *edges;
+    const int *adjacency_offsets;
+    const int *adjacency;
+    int component_count;
+    const int *component_edges;
+    const int *component_vertex_offsets;
+    const int *component_vertices;
+    int *component_best;
+};
+
+
+/**
+  * Load Graph File function
+  * @brief Load the edges of a graph file
+  * @details Accepts DIMACS .col files ("p edge N M", "e u v") and plain edge lists
+  * with one "u v" or "u-v" per line. Lines starting with c, # or % are comments.
+  * @param path path of the file
+  * @param raw the edges are stored here
+  * @return 0 on success, -1 on failure (the reason is printed to stderr)
+**/
+int load_graph_file(const char *path, struct RawGraph *raw);
+
+/**
+  * Load Graph Arguments function
+  * @brief Load the edges given as [d-d] arguments
+  * @param args the arguments
+  * @param count number of arguments
+  * @param raw the edges are stored here
+  * @return 0 on success, -1 if an argument is not an edge
+**/
+int load_graph_arguments(char **args, int count, struct RawGraph *raw);
+
+/**
+  * Prepare Graph function
+  * @brief Number the vertices of a raw graph
+  * @details Collects the distinct node values into labels and rewrites the edges
+  * to vertex indices with u <= v. Edges given more than once, also in both
+  * directions, are kept once.
+  * @param raw the graph to prepare
+  * @return 0 on success, -1 on failure
+**/
+int prepare_graph(struct RawGraph *raw);
+
+/**
+  * Split Components function
+  * @brief Find the connected components of a prepared graph
+  * @details Uses union-find over the edges.
+  * @param raw the prepared graph
+  * @return 0 on success, -1 on failure
+**/
+int split_components(struct RawGraph *raw);
+
+/**
+  * Free Raw Graph function
+  * @brief Free the memory of a raw graph
+  * @param raw the graph to free
+**/
+void free_raw_graph(struct RawGraph *raw);
+
+/**
+  * Graph Segment Size function
+  * @brief Size in bytes of the segment for a prepared graph
+  * @param raw the prepared graph
+  * @return the size
+**/
+size_t graph_segment_size(const struct RawGraph *raw);
+
+/**
+  * Layout Graph function
+  * @brief Build the segment of a prepared graph
+  * @details Writes the header, labels, edges grouped by component, the adjacency
+  * and the component tables to memory. Every component starts without a result.
+  * The size in the header is stored last, until then it is 0.
+  * @param memory at least graph_segment_size bytes
+  * @param raw the prepared graph
+**/
+void layout_graph(void *memory, const struct RawGraph *raw);
+
+/**
+  * Attach Graph function
+  * @brief Set up the view of a graph segment
+  * @param memory the segment built by layout_graph
+  * @param graph the view
+**/
+void attach_graph(const void *memory, struct Graph *graph);
+
+/**
+  * Publish Graph function
+  * @brief Place a prepared graph in shared memory
+  * @details Used by the supervisor. The segment stays until close_graph(true).
+  * @param raw the prepared graph
+  * @param graph view of the shared segment
+  * @return 0 on success, -1 on failure
+**/
+int publish_graph(const struct RawGraph *raw, struct Graph *graph);
+
+/**
+  * Open Shared Graph function
+  * @brief Attach read-only to the graph published by the supervisor
+  * @details A segment whose layout isn't finished yet is not attached.
+  * @param graph view of the shared segment
+  * @return 0 on success, -1 if there is no shared graph
+**/
+int open_shared_graph(struct Graph *graph);
+
+/**
+  * Close Graph function
+  * @brief Unmap the shared graph
+  * @details Does nothing if no graph is mapped.
+  * @param isSupervisor the supervisor also unlinks the segment
+**/
+void close_graph(bool isSupervisor);
+
+#endif
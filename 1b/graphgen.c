@@ -0,0 +1,343 @@
+/**
+  * @file graphgen.c
+  * @author
+  * @date 13.11.2022
+
+  * @brief The graph generator module
+  * @details Writes a random graph as edge list to stdout, which the supervisor can load.
+  * Three kinds of graphs can be generated: Erdős–Rényi graphs with a fixed number of edges,
+  * graphs with a planted k colouring and random geometric graphs in the unit square.
+  * The same seed always gives the same graph.
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <math.h>
+
+#include "colouring.h"
+
+char *progname;
+
+/**
+  * Structure for the edge set
+  * @brief Open addressing hash set of edges
+  * @details An edge u < v is stored as u * vertexCount + v + 1, 0 marks a free slot.
+**/
+struct EdgeSet{
+    uint64_t *keys;
+    size_t mask;
+};
+
+/**
+  * Usage function
+  * @brief explains how to use the programm
+  * @details If the user provides wrong argument, show usage message and
+  * exit on EXIT_FAILURE
+**/
+void usage(void){
+    fprintf(stderr, "Usage: %s [-t er|planted|geometric] [-k K] [-s SEED] VERTICES EDGES\n"
+        "-t er connects random pairs of vertices (default).\n"
+        "-t planted only connects vertices of different colours of a hidden k colouring.\n"
+        "-t geometric connects random points of the unit square which are close.\n"
+        "-k K colours of the planted colouring, 2 to 64 (default 3).\n"
+        "-s SEED seed of the random generator (default 1).\n"
+        "EDGES is exact for er and planted and expected for geometric.\n", progname);
+    exit(EXIT_FAILURE);
+}
+
+/**
+  * Failed Exit function
+  * @brief Print the message and exit on EXIT_FAILURE
+  * @param msg the message
+**/
+void failed_exit(char *msg){
+    fprintf(stderr, "%s: %s", progname, msg);
+    exit(EXIT_FAILURE);
+}
+
+/**
+  * Parse Number function
+  * @brief Parse a non negative number
+  * @param arg the argument
+  * @param max the largest allowed number
+  * @return the number, exits with usage on a wrong number
+**/
+long long parse_number(const char *arg, long long max){
+    char *endptr;
+    errno = 0;
+    long long number = strtoll(arg, &endptr, 10);
+
+    if(errno != 0 || endptr == arg || *endptr != '\0' || number < 0 || number > max){
+        usage();
+    }
+    return number;
+}
+
+/**
+  * Random Below function
+  * @brief Uniform random number in [0, bound)
+  * @param random the random generator
+  * @param bound the bound, larger than 0
+**/
+uint64_t random_below(struct Random *random, uint64_t bound){
+    uint64_t limit = UINT64_MAX - UINT64_MAX % bound;
+    uint64_t value;
+    do{
+        value = next_random(random);
+    }while(value >= limit);
+    return value % bound;
+}
+
+/**
+  * Random Unit function
+  * @brief Uniform random number in [0, 1)
+  * @param random the random generator
+**/
+double random_unit(struct Random *random){
+    return (next_random(random) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+  * Insert Edge function
+  * @brief Add an edge to the set
+  * @param set the set, never more than half full
+  * @param key the edge
+  * @return true if the edge was new
+**/
+bool insert_edge(struct EdgeSet *set, uint64_t key){
+    size_t i = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 17) & set->mask;
+    while(set->keys[i] != 0){
+        if(set->keys[i] == key){
+            return false;
+        }
+        i = (i + 1) & set->mask;
+    }
+    set->keys[i] = key;
+    return true;
+}
+
+/**
+  * Sample Edges function
+  * @brief Print edges between random pairs of vertices
+  * @details With colours only pairs of different colours are connected.
+  * @param vertices number of vertices
+  * @param edges number of edges
+  * @param colours colour of every vertex or NULL
+  * @param random the random generator
+**/
+void sample_edges(long long vertices, long long edges, const unsigned char *colours, struct Random *random){
+    struct EdgeSet set;
+    size_t slots = 16;
+    while(slots < (size_t)edges * 2){
+        slots *= 2;
+    }
+    set.keys = calloc(slots, sizeof(uint64_t));
+    if(set.keys == NULL){
+        failed_exit("Malloc failed. \n");
+    }
+    set.mask = slots - 1;
+
+    for(long long i = 0; i < edges;){
+        uint64_t u = random_below(random, vertices);
+        uint64_t v = random_below(random, vertices);
+        if(u == v || (colours != NULL && colours[u] == colours[v])){
+            continue;
+        }
+        if(u > v){
+            uint64_t swap = u;
+            u = v;
+            v = swap;
+        }
+        if(insert_edge(&set, u * vertices + v + 1)){
+            printf("%llu %llu\n", (unsigned long long)u + 1, (unsigned long long)v + 1);
+            i++;
+        }
+    }
+    free(set.keys);
+}
+
+/**
+  * Geometric Edges function
+  * @brief Print the edges of a random geometric graph
+  * @details The points are sorted into cells as large as the radius, so only
+  * the neighbouring cells have to be searched.
+  * @param vertices number of vertices
+  * @param edges expected number of edges
+  * @param random the random generator
+**/
+void geometric_edges(long long vertices, long long edges, struct Random *random){
+    double radius = sqrt(edges / (M_PI * vertices * (vertices - 1) / 2.0));
+    long long cells = radius > 0 ? (long long)(1 / radius) : 1;
+    if(cells < 1){
+        cells = 1;
+    }
+    if(cells * cells > vertices){
+        cells = (long long)sqrt((double)vertices);
+    }
+
+    double *x = malloc(sizeof(double) * vertices);
+    double *y = malloc(sizeof(double) * vertices);
+    long long *cellStart = calloc(cells * cells + 1, sizeof(long long));
+    long long *order = malloc(sizeof(long long) * vertices);
+    if(x == NULL || y == NULL || cellStart == NULL || order == NULL){
+        failed_exit("Malloc failed. \n");
+    }
+
+    for(long long i = 0; i < vertices; i++){
+        x[i] = random_unit(random);
+        y[i] = random_unit(random);
+        cellStart[(long long)(y[i] * cells) * cells + (long long)(x[i] * cells) + 1]++;
+    }
+    for(long long c = 0; c < cells * cells; c++){
+        cellStart[c + 1] += cellStart[c];
+    }
+    for(long long i = 0; i < vertices; i++){
+        long long c = (long long)(y[i] * cells) * cells + (long long)(x[i] * cells);
+        order[cellStart[c]++] = i;
+    }
+    //cellStart[c] is now the end of cell c
+    for(long long c = cells * cells; c > 0; c--){
+        cellStart[c] = cellStart[c - 1];
+    }
+    cellStart[0] = 0;
+
+    double square = radius * radius;
+    for(long long cy = 0; cy < cells; cy++){
+        for(long long cx = 0; cx < cells; cx++){
+            for(long long a = cellStart[cy * cells + cx]; a < cellStart[cy * cells + cx + 1]; a++){
+                long long u = order[a];
+                for(long long ny = cy; ny <= cy + 1 && ny < cells; ny++){
+                    for(long long nx = cx - 1; nx <= cx + 1; nx++){
+                        //every pair of cells is only searched once
+                        if(nx < 0 || nx >= cells || (ny == cy && nx < cx)){
+                            continue;
+                        }
+                        long long n = ny * cells + nx;
+                        for(long long b = n == cy * cells + cx ? a + 1 : cellStart[n]; b < cellStart[n + 1]; b++){
+                            long long v = order[b];
+                            double dx = x[u] - x[v];
+                            double dy = y[u] - y[v];
+                            if(dx * dx + dy * dy <= square){
+                                printf("%lld %lld\n", u + 1, v + 1);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    free(x);
+    free(y);
+    free(cellStart);
+    free(order);
+}
+
+/**
+  * Main function
+  * @brief entry point to the program
+  * @details Parses the arguments and prints the graph.
+  * @param argc
+  * @param argv
+  * @return EXIT_SUCCESS or EXIT_FAILURE
+**/
+int main(int argc, char **argv){
+    progname = argv[0];
+
+    char *type = NULL;
+    long long colourCount = 0;
+    char *seed = NULL;
+    int c = 0;
+
+    while((c = getopt(argc, argv, "t:k:s:")) != -1){
+        switch (c){
+            case 't':
+                if(type != NULL){
+                    usage();
+                }
+                type = optarg;
+                break;
+            case 'k':
+                if(colourCount != 0){
+                    usage();
+                }
+                colourCount = parse_number(optarg, MAX_COLOURS);
+                if(colourCount < MIN_COLOURS){
+                    usage();
+                }
+                break;
+            case 's':
+                if(seed != NULL){
+                    usage();
+                }
+                seed = optarg;
+                break;
+            default:
+                usage();
+                break;
+        }
+    }
+
+    if(argc - optind != 2){
+        usage();
+    }
+    if(type == NULL){
+        type = "er";
+    }
+    if(colourCount == 0){
+        colourCount = 3;
+    }
+
+    //the node values have to fit into an int
+    long long vertices = parse_number(argv[optind], 1LL << 30);
+    long long edges = parse_number(argv[optind + 1], 1LL << 30);
+    double pairs = vertices * (vertices - 1) / 2.0;
+
+    struct Random random;
+    seed_random(&random, seed != NULL ? (uint64_t)parse_number(seed, INT64_MAX) : 1);
+
+    printf("# %s graph with %lld vertices, %lld edges\n", type, vertices, edges);
+
+    if(strcmp(type, "er") == 0){
+        if(edges > pairs / 2){
+            failed_exit("Too many edges, at most half of the pairs can be connected. \n");
+        }
+        sample_edges(vertices, edges, NULL, &random);
+    }
+    else if(strcmp(type, "planted") == 0){
+        unsigned char *colours = malloc(vertices > 0 ? vertices : 1);
+        if(colours == NULL){
+            failed_exit("Malloc failed. \n");
+        }
+        for(long long i = 0; i < vertices; i++){
+            colours[i] = (unsigned char)random_below(&random, colourCount);
+        }
+        //pairs of different colours are at least this many, if the colours are even
+        if(edges > pairs * (colourCount - 1) / colourCount / 4){
+            failed_exit("Too many edges for the planted colouring. \n");
+        }
+        sample_edges(vertices, edges, colours, &random);
+        free(colours);
+    }
+    else if(strcmp(type, "geometric") == 0){
+        if(edges > pairs / 4){
+            failed_exit("Too many edges for a geometric graph. \n");
+        }
+        if(edges > 0){
+            geometric_edges(vertices, edges, &random);
+        }
+    }
+    else{
+        usage();
+    }
+
+    if(fflush(stdout) == EOF){
+        failed_exit("Couldn't write the graph. \n");
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,224 @@
+/**
+  * @file pool.c
+  * @author
+  * @date 13.11.2022
+  * @brief Implementation of pool.h
+**/
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "pool.h"
+
+#define EXEC_FAILED (127)
+#define STOP_TIMEOUT_MS (1000)
+
+//Crashes in a row after which a slot isn't restarted anymore
+#define MAX_RESTARTS (5)
+//Delay before the first restart, doubled for every further crash in a row
+#define RESTART_DELAY_MS (100)
+//A crash after running this long doesn't count as a crash in a row
+#define STABLE_SECONDS (10)
+
+//Running generators, 0 for a free slot
+static pid_t *generators = NULL;
+//Crashes in a row and start time of every slot
+static int *crashes = NULL;
+static time_t *started = NULL;
+static int generatorCount = 0;
+static char **generatorArgs = NULL;
+
+
+char *generator_path(const char *supervisorPath){
+    const char *slash = strrchr(supervisorPath, '/');
+    if(slash == NULL){
+        return strdup("generator");
+    }
+
+    size_t dirLength = slash - supervisorPath + 1;
+    char *path = malloc(dirLength + sizeof("generator"));
+    if(path == NULL){
+        return NULL;
+    }
+    memcpy(path, supervisorPath, dirLength);
+    strcpy(path + dirLength, "generator");
+    return path;
+}
+
+/**
+  * Pin To Core function
+  * @brief Pin the calling process to one core
+  * @details The slot-th core the supervisor may run on is used, wrapping around
+  * if there are more generators than cores.
+  * @param slot the generator slot
+**/
+static void pin_to_core(int slot){
+    cpu_set_t allowed;
+    if(sched_getaffinity(0, sizeof(allowed), &allowed) == -1){
+        return;
+    }
+
+    int cores = CPU_COUNT(&allowed);
+    if(cores <= 1){
+        return;
+    }
+
+    int target = slot % cores;
+    for(int cpu = 0; cpu < CPU_SETSIZE; cpu++){
+        if(CPU_ISSET(cpu, &allowed) && target-- == 0){
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            sched_setaffinity(0, sizeof(set), &set);
+            return;
+        }
+    }
+}
+
+/**
+  * Monotonic Now function
+  * @brief Seconds of the monotonic clock
+**/
+static time_t monotonic_now(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec;
+}
+
+/**
+  * Spawn Generator function
+  * @brief Fork and execute the generator of a slot
+  * @details The child waits before executing the generator, so the slot is
+  * counted as running meanwhile and the supervisor needs no timer for it.
+  * @param slot the generator slot
+  * @param delayMs milliseconds to wait before executing
+  * @return 0 on success, -1 if forking failed
+**/
+static int spawn_generator(int slot, long delayMs){
+    pid_t pid = fork();
+
+    if(pid == -1){
+        return -1;
+    }
+
+    if(pid == 0){
+        //The handlers of the supervisor would only set its quit flag
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+        struct timespec delay = {.tv_sec = delayMs / 1000, .tv_nsec = delayMs % 1000 * 1000000};
+        nanosleep(&delay, NULL);
+
+        pin_to_core(slot);
+        execvp(generatorArgs[0], generatorArgs);
+        fprintf(stderr, "Couldn't execute %s: %s\n", generatorArgs[0], strerror(errno));
+        _exit(EXEC_FAILED);
+    }
+
+    generators[slot] = pid;
+    started[slot] = monotonic_now();
+    return 0;
+}
+
+int start_pool(int count, char **args){
+    generators = calloc(count, sizeof(pid_t));
+    crashes = calloc(count, sizeof(int));
+    started = calloc(count, sizeof(time_t));
+    if(generators == NULL || crashes == NULL || started == NULL){
+        return -1;
+    }
+    generatorCount = count;
+    generatorArgs = args;
+
+    for(int slot = 0; slot < count; slot++){
+        if(spawn_generator(slot, 0) == -1){
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int reap_pool(bool restart){
+    pid_t pid;
+    int status;
+
+    while((pid = waitpid(-1, &status, WNOHANG)) > 0){
+        for(int slot = 0; slot < generatorCount; slot++){
+            if(generators[slot] != pid){
+                continue;
+            }
+            generators[slot] = 0;
+
+            //Ctrl+c and kill reach the generators too, they were stopped on purpose
+            bool stopped = WIFSIGNALED(status) && (WTERMSIG(status) == SIGINT || WTERMSIG(status) == SIGTERM);
+            bool crashed = WIFSIGNALED(status) || (WIFEXITED(status) && WEXITSTATUS(status) != EXIT_SUCCESS);
+            if(!restart || !crashed || stopped){
+                break;
+            }
+            if(WIFEXITED(status) && WEXITSTATUS(status) == EXEC_FAILED){
+                fprintf(stderr, "Generator %d couldn't be started, not restarting it. \n", slot);
+                break;
+            }
+
+            if(monotonic_now() - started[slot] >= STABLE_SECONDS){
+                crashes[slot] = 0;
+            }
+            if(++crashes[slot] > MAX_RESTARTS){
+                fprintf(stderr, "Generator %d crashed %d times in a row, not restarting it. \n", slot, MAX_RESTARTS);
+                break;
+            }
+
+            long delayMs = RESTART_DELAY_MS << (crashes[slot] - 1);
+            fprintf(stderr, "Generator %d crashed, restarting it in %ld ms. \n", slot, delayMs);
+            if(spawn_generator(slot, delayMs) == -1){
+                fprintf(stderr, "Couldn't restart generator %d. \n", slot);
+            }
+            break;
+        }
+    }
+
+    int running = 0;
+    for(int slot = 0; slot < generatorCount; slot++){
+        if(generators[slot] != 0){
+            running++;
+        }
+    }
+    return running;
+}
+
+void stop_pool(void){
+    if(generators == NULL){
+        return;
+    }
+
+    struct timespec pause = {.tv_sec = 0, .tv_nsec = 10 * 1000 * 1000};
+    for(int waited = 0; waited < STOP_TIMEOUT_MS; waited += 10){
+        if(reap_pool(false) == 0){
+            break;
+        }
+        nanosleep(&pause, NULL);
+    }
+
+    for(int slot = 0; slot < generatorCount; slot++){
+        if(generators[slot] != 0){
+            kill(generators[slot], SIGKILL);
+            waitpid(generators[slot], NULL, 0);
+            generators[slot] = 0;
+        }
+    }
+
+    free(generators);
+    free(crashes);
+    free(started);
+    generators = NULL;
+    crashes = NULL;
+    started = NULL;
+    generatorCount = 0;
+}
@@ -0,0 +1,56 @@
+/**
+  * @file pool.h
+  * @author
+  * @date 13.11.2022
+  * @brief The module for the generators started by the supervisor.
+  * @details The supervisor forks the generators, pins every one to its own core,
+  * restarts generators which crashed with a growing delay and reaps all of them on shutdown.
+**/
+#include <stdbool.h>
+#include <sys/types.h>
+
+
+#ifndef POOL_H
+#define POOL_H
+
+
+/**
+  * Generator Path function
+  * @brief Find the generator next to the supervisor
+  * @details If the supervisor was started with a path, the generator in the same
+  * directory is used, else generator is searched in PATH.
+  * @param supervisorPath argv[0] of the supervisor
+  * @return the path, to be freed by the caller, or NULL if no memory is left
+**/
+char *generator_path(const char *supervisorPath);
+
+/**
+  * Start Pool function
+  * @brief Fork the generators
+  * @param count number of generators
+  * @param args argument vector for the generators, args[0] is the path
+  * @return 0 on success, -1 on failure
+**/
+int start_pool(int count, char **args);
+
+/**
+  * Reap Pool function
+  * @brief Reap exited generators and restart crashed ones
+  * @details A generator crashed if it was killed by a signal other than SIGINT or
+  * SIGTERM or exited with an error. Restarts wait 100 ms, doubled for every crash
+  * in a row, and a slot which crashed 5 times in a row isn't restarted anymore.
+  * Generators which couldn't be executed are not restarted.
+  * @param restart false during shutdown
+  * @return number of generators still running
+**/
+int reap_pool(bool restart);
+
+/**
+  * Stop Pool function
+  * @brief Wait for all generators to exit
+  * @details The generators must already have been told to stop. Generators
+  * which don't exit in time are killed. Returns after all of them were reaped.
+**/
+void stop_pool(void);
+
+#endif
@@ -0,0 +1,244 @@
+/**
+  * @file ringbench.c
+  * @author
+  * @date 13.11.2022
+
+  * @brief The ring benchmark module
+  * @details Measures what sharing cache lines between the producer and the consumer
+  * of a ring costs. A producer process and a consumer process, pinned to different
+  * cores, pass results through a ring in shared memory, once with the indices and
+  * results packed like the old buffer and once padded like struct Buffer.
+  * The ring spins instead of using semaphores, so the cache line transfers dominate.
+**/
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+
+#include "circularBuffer.h"
+
+char *progname;
+
+/**
+  * Structure for the packed ring
+  * @brief The layout of the buffer before the fields were separated
+**/
+struct PackedRing{
+    unsigned int read_index;
+    unsigned int write_index;
+    struct Result results[BUFFER_SIZE];
+};
+
+/**
+  * Structure for the padded ring
+  * @brief The layout of struct Buffer
+**/
+struct PaddedRing{
+    unsigned int write_index __attribute__((aligned(CACHE_LINE)));
+    unsigned int read_index __attribute__((aligned(CACHE_LINE)));
+    struct ResultSlot results[BUFFER_SIZE];
+};
+
+/**
+  * Usage function
+  * @brief explains how to use the programm
+  * @details If the user provides wrong argument, show usage message and
+  * exit on EXIT_FAILURE
+**/
+void usage(void){
+    fprintf(stderr, "Usage: %s [-n TRANSFERS]\n"
+        "-n TRANSFERS results passed through each ring (default 2000000).\n", progname);
+    exit(EXIT_FAILURE);
+}
+
+/**
+  * Failed Exit function
+  * @brief Print the message and exit on EXIT_FAILURE
+  * @param msg the message
+**/
+void failed_exit(char *msg){
+    fprintf(stderr, "%s: %s", progname, msg);
+    exit(EXIT_FAILURE);
+}
+
+/**
+  * Allowed Cpu function
+  * @brief The n-th cpu this process may run on
+  * @param n index among the allowed cpus
+  * @return the cpu, -1 if there are not that many
+**/
+int allowed_cpu(int n){
+    cpu_set_t set;
+    if(sched_getaffinity(0, sizeof(set), &set) == -1){
+        return -1;
+    }
+    for(int cpu = 0; cpu < CPU_SETSIZE; cpu++){
+        if(CPU_ISSET(cpu, &set) && n-- == 0){
+            return cpu;
+        }
+    }
+    return -1;
+}
+
+/**
+  * Pin function
+  * @brief Run the calling process on one cpu only
+  * @param cpu the cpu, -1 leaves the affinity as it is
+**/
+void pin(int cpu){
+    if(cpu < 0){
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+}
+
+/**
+  * Monotonic Seconds function
+  * @brief Seconds on the monotonic clock
+**/
+double monotonic_seconds(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+//Single producer single consumer ring over either layout, the indices count up forever
+#define DEFINE_RING(NAME, TYPE, SLOT) \
+static void produce_##NAME(TYPE *ring, long transfers){ \
+    struct Result result = {.amount = 0}; \
+    for(long i = 0; i < transfers; i++){ \
+        unsigned int write = __atomic_load_n(&ring->write_index, __ATOMIC_RELAXED); \
+        while(write - __atomic_load_n(&ring->read_index, __ATOMIC_ACQUIRE) == BUFFER_SIZE){ \
+        } \
+        result.amount = (int)i; \
+        result.component = (int)i; \
+        result.edges[0].n1.value = (int)i; \
+        SLOT(ring, write % BUFFER_SIZE) = result; \
+        __atomic_store_n(&ring->write_index, write + 1, __ATOMIC_RELEASE); \
+    } \
+} \
+static long consume_##NAME(TYPE *ring, long transfers){ \
+    long sum = 0; \
+    for(long i = 0; i < transfers; i++){ \
+        unsigned int read = __atomic_load_n(&ring->read_index, __ATOMIC_RELAXED); \
+        while(__atomic_load_n(&ring->write_index, __ATOMIC_ACQUIRE) == read){ \
+        } \
+        struct Result result = SLOT(ring, read % BUFFER_SIZE); \
+        sum += result.amount + result.edges[0].n1.value; \
+        __atomic_store_n(&ring->read_index, read + 1, __ATOMIC_RELEASE); \
+    } \
+    return sum; \
+}
+
+#define PACKED_SLOT(ring, i) ((ring)->results[i])
+#define PADDED_SLOT(ring, i) ((ring)->results[i].result)
+
+DEFINE_RING(packed, struct PackedRing, PACKED_SLOT)
+DEFINE_RING(padded, struct PaddedRing, PADDED_SLOT)
+
+/**
+  * Run function
+  * @brief Pass results through one ring from a producer process to this process
+  * @param padded which layout to use
+  * @param transfers number of results
+  * @param producerCpu cpu of the producer
+  * @param consumerCpu cpu of this process
+  * @return nanoseconds per result
+**/
+double run(bool padded, long transfers, int producerCpu, int consumerCpu){
+    size_t size = padded ? sizeof(struct PaddedRing) : sizeof(struct PackedRing);
+    void *ring = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(ring == MAP_FAILED){
+        failed_exit("mmap failed. \n");
+    }
+
+    pin(consumerCpu);
+    pid_t pid = fork();
+    if(pid == -1){
+        failed_exit("Fork failed. \n");
+    }
+    if(pid == 0){
+        pin(producerCpu);
+        if(padded){
+            produce_padded(ring, transfers);
+        }
+        else{
+            produce_packed(ring, transfers);
+        }
+        _exit(EXIT_SUCCESS);
+    }
+
+    double start = monotonic_seconds();
+    long sum = padded ? consume_padded(ring, transfers) : consume_packed(ring, transfers);
+    double seconds = monotonic_seconds() - start;
+
+    int status;
+    if(waitpid(pid, &status, 0) == -1 || !WIFEXITED(status) || status != 0
+        || sum != transfers * (transfers - 1)){
+        failed_exit("The producer failed. \n");
+    }
+    munmap(ring, size);
+    return seconds * 1e9 / transfers;
+}
+
+/**
+  * Main function
+  * @brief entry point to the program
+  * @details Runs both layouts and prints the cost per result.
+  * @param argc
+  * @param argv
+  * @return EXIT_SUCCESS or EXIT_FAILURE
+**/
+int main(int argc, char **argv){
+    progname = argv[0];
+    long transfers = 2000000;
+    int c = 0;
+
+    while((c = getopt(argc, argv, "n:")) != -1){
+        switch (c){
+            case 'n':{
+                char *endptr;
+                errno = 0;
+                transfers = strtol(optarg, &endptr, 10);
+                if(errno != 0 || endptr == optarg || *endptr != '\0' || transfers < 1 || transfers > 1000000000L){
+                    usage();
+                }
+                break;
+            }
+            default:
+                usage();
+                break;
+        }
+    }
+    if(optind != argc){
+        usage();
+    }
+
+    int producerCpu = allowed_cpu(0);
+    int consumerCpu = allowed_cpu(1);
+    //Spinning processes sharing a cpu would only measure the scheduler
+    if(consumerCpu == -1){
+        failed_exit("At least two cpus are needed. \n");
+    }
+
+    double packed = run(false, transfers, producerCpu, consumerCpu);
+    double padded = run(true, transfers, producerCpu, consumerCpu);
+
+    fprintf(stdout, "cpus %d -> %d, %ld results, %zu/%zu bytes per slot\n", producerCpu, consumerCpu, transfers,
+        sizeof(struct Result), sizeof(struct ResultSlot));
+    fprintf(stdout, "packed: %.1f ns/result\n", packed);
+    fprintf(stdout, "padded: %.1f ns/result\n", padded);
+    fprintf(stdout, "speedup: %.2fx\n", packed / padded);
+    return EXIT_SUCCESS;
+}
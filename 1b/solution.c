@@ -0,0 +1,313 @@
+/**
+  * @file solution.c
+  * @author
+  * @date 13.11.2022
+  * @brief Implementation of solution.h
+**/
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <limits.h>
+#include <errno.h>
+#include <sched.h>
+
+#include "solution.h"
+#include "circularBuffer.h"
+#include "colouring.h"
+
+//Attempts of read_solution before it gives up
+#define READ_ATTEMPTS (1000)
+
+/**
+  * Structure for the solution header
+  * @brief The header at the start of the solution segment
+  * @details It is followed by one slot for every component and the colours,
+  * which are stored in the order of component_vertices.
+**/
+struct SolutionHeader{
+    size_t size;
+    int component_count;
+    int vertex_count;
+};
+
+static void *solution_memory = NULL;
+static size_t solution_size = 0;
+static struct SolutionSlot *slots = NULL;
+static unsigned char *slot_colours = NULL;
+
+
+/**
+  * Solution Segment Size function
+  * @brief Size in bytes of the solution segment for a graph
+**/
+static size_t solution_segment_size(const struct Graph *graph){
+    return sizeof(struct SolutionHeader) + sizeof(struct SolutionSlot) * graph->component_count
+        + graph->vertex_count;
+}
+
+/**
+  * Attach Solution function
+  * @brief Set up the pointers into a mapped solution segment
+**/
+static void attach_solution(void *memory, size_t size, const struct Graph *graph){
+    solution_memory = memory;
+    solution_size = size;
+    slots = (struct SolutionSlot *)((char *)memory + sizeof(struct SolutionHeader));
+    slot_colours = (unsigned char *)(slots + graph->component_count);
+}
+
+int create_solution(const struct Graph *graph){
+    size_t size = solution_segment_size(graph);
+    char name[MAX_NAME];
+    instance_name(name, SHM_SOLUTION);
+
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(fd == -1){
+        return -1;
+    }
+
+    if(ftruncate(fd, size) < 0){
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+
+    void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(memory == MAP_FAILED){
+        shm_unlink(name);
+        return -1;
+    }
+
+    struct SolutionHeader *header = memory;
+    header->size = size;
+    header->component_count = graph->component_count;
+    header->vertex_count = graph->vertex_count;
+
+    attach_solution(memory, size, graph);
+    for(int c = 0; c < graph->component_count; c++){
+        slots[c].amount = INT_MAX;
+    }
+    return 0;
+}
+
+int open_solution(const struct Graph *graph){
+    char name[MAX_NAME];
+    instance_name(name, SHM_SOLUTION);
+
+    int fd = shm_open(name, O_RDWR, 0);
+    if(fd == -1){
+        return -1;
+    }
+
+    size_t size = solution_segment_size(graph);
+    struct stat st;
+    if(fstat(fd, &st) == -1 || (size_t)st.st_size != size){
+        close(fd);
+        return -1;
+    }
+
+    void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(memory == MAP_FAILED){
+        return -1;
+    }
+
+    const struct SolutionHeader *header = memory;
+    if(header->size != size || header->component_count != graph->component_count
+        || header->vertex_count != graph->vertex_count){
+        munmap(memory, size);
+        return -1;
+    }
+
+    attach_solution(memory, size, graph);
+    return 0;
+}
+
+void close_solution(bool isSupervisor){
+    if(solution_memory == NULL){
+        return;
+    }
+
+    munmap(solution_memory, solution_size);
+    solution_memory = NULL;
+    solution_size = 0;
+    slots = NULL;
+    slot_colours = NULL;
+
+    if(isSupervisor){
+        char name[MAX_NAME];
+        instance_name(name, SHM_SOLUTION);
+        shm_unlink(name);
+    }
+}
+
+/**
+  * Lock Slot function
+  * @brief Take a slot for writing
+  * @details The slot of a generator which died while writing is taken over,
+  * its colours are torn, so the slot is emptied.
+  * @param slot the slot
+**/
+static void lock_slot(struct SolutionSlot *slot){
+    pid_t self = getpid();
+
+    for(;;){
+        pid_t writer = 0;
+        if(__atomic_compare_exchange_n(&slot->writer, &writer, self, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)){
+            break;
+        }
+        if(kill(writer, 0) == -1 && errno == ESRCH
+            && __atomic_compare_exchange_n(&slot->writer, &writer, self, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)){
+            if(__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) % 2 == 1){
+                __atomic_store_n(&slot->amount, INT_MAX, __ATOMIC_RELAXED);
+                __atomic_add_fetch(&slot->seq, 1, __ATOMIC_RELEASE);
+            }
+            break;
+        }
+        sched_yield();
+    }
+}
+
+void offer_solution(const struct Graph *graph, int component, const unsigned char *colours, int amount){
+    if(slots == NULL){
+        return;
+    }
+
+    struct SolutionSlot *slot = &slots[component];
+    if(amount >= __atomic_load_n(&slot->amount, __ATOMIC_RELAXED)){
+        return;
+    }
+
+    lock_slot(slot);
+    if(amount < slot->amount){
+        //Odd while writing, the stores below may not move before it
+        __atomic_add_fetch(&slot->seq, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+
+        for(int i = graph->component_vertex_offsets[component]; i < graph->component_vertex_offsets[component + 1]; i++){
+            slot_colours[i] = colours[graph->component_vertices[i]];
+        }
+        __atomic_store_n(&slot->amount, amount, __ATOMIC_RELAXED);
+
+        __atomic_add_fetch(&slot->seq, 1, __ATOMIC_RELEASE);
+    }
+    __atomic_store_n(&slot->writer, 0, __ATOMIC_RELEASE);
+}
+
+int read_solution(const struct Graph *graph, int component, unsigned char *colours){
+    if(slots == NULL){
+        return -1;
+    }
+
+    struct SolutionSlot *slot = &slots[component];
+    for(int attempt = 0; attempt < READ_ATTEMPTS; attempt++){
+        unsigned int seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if(seq % 2 == 1){
+            sched_yield();
+            continue;
+        }
+
+        int amount = __atomic_load_n(&slot->amount, __ATOMIC_RELAXED);
+        for(int i = graph->component_vertex_offsets[component]; i < graph->component_vertex_offsets[component + 1]; i++){
+            colours[graph->component_vertices[i]] = slot_colours[i];
+        }
+
+        //The copy is only valid if no generator wrote in between
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if(__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq){
+            return amount;
+        }
+    }
+    return -1;
+}
+
+int write_checkpoint(const char *path, const struct Graph *graph, const unsigned char *colours, int k, int amount){
+    size_t length = strlen(path);
+    char *temporary = malloc(length + sizeof(".tmp"));
+    if(temporary == NULL){
+        return -1;
+    }
+    memcpy(temporary, path, length);
+    memcpy(temporary + length, ".tmp", sizeof(".tmp"));
+
+    FILE *file = fopen(temporary, "w");
+    if(file == NULL){
+        free(temporary);
+        return -1;
+    }
+
+    fprintf(file, "# k=%d removed=%d\n", k, amount);
+    for(int v = 0; v < graph->vertex_count; v++){
+        fprintf(file, "%d %d\n", graph->labels[v], colours[v]);
+    }
+
+    //The data has to be on disk before the rename makes it the checkpoint
+    bool failed = fflush(file) == EOF || fsync(fileno(file)) == -1;
+    failed |= fclose(file) == EOF;
+    if(failed || rename(temporary, path) == -1){
+        unlink(temporary);
+        free(temporary);
+        return -1;
+    }
+
+    free(temporary);
+    return 0;
+}
+
+/**
+  * Compare Int function
+  * @brief Compare function for bsearch
+**/
+static int compare_int(const void *a, const void *b){
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+int load_checkpoint(const char *path, const struct Graph *graph, unsigned char *colours, int k){
+    FILE *file = fopen(path, "r");
+    if(file == NULL){
+        return -1;
+    }
+
+    char *line = NULL;
+    size_t capacity = 0;
+    int result = 0;
+    while(getline(&line, &capacity, file) != -1){
+        if(line[0] == '#' || line[0] == '\n'){
+            continue;
+        }
+
+        int value;
+        int colour;
+        char end;
+        if(sscanf(line, "%d %d %c", &value, &colour, &end) != 2 || colour < 0 || colour >= MAX_COLOURS){
+            result = -1;
+            errno = EINVAL;
+            break;
+        }
+
+        //The labels are sorted by prepare_graph
+        const int *label = bsearch(&value, graph->labels, graph->vertex_count, sizeof(int), compare_int);
+        if(label == NULL){
+            result = -1;
+            errno = EINVAL;
+            break;
+        }
+        colours[label - graph->labels] = (unsigned char)(colour % k);
+    }
+
+    if(result == 0 && ferror(file)){
+        result = -1;
+    }
+    free(line);
+    fclose(file);
+    return result;
+}
@@ -0,0 +1,113 @@
+/**
+  * @file solution.h
+  * @author
+  * @date 13.11.2022
+  * @brief The module for the best colouring and its checkpoint files.
+  * @details Results in the buffer only hold the removed edges, so the generators also
+  * offer the colouring of every improving result to a shared solution segment. The
+  * supervisor reads it from there and saves the best colouring to a checkpoint file,
+  * which generators can load to warm-start the local search after a restart.
+**/
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "graph.h"
+
+
+#ifndef SOLUTION_H
+#define SOLUTION_H
+
+
+//Object name, see instance_name in circularBuffer.h
+#define SHM_SOLUTION "solution"
+
+
+/**
+  * Structure for the solution slot
+  * @brief The best colouring of one component
+  * @details writer is the pid of the generator holding the slot. seq is odd while
+  * the colours are written, so the supervisor can read without taking the slot.
+**/
+struct SolutionSlot{
+    pid_t writer;
+    unsigned int seq;
+    int amount;
+};
+
+
+/**
+  * Create Solution function
+  * @brief Create the solution segment for a shared graph
+  * @details Used by the supervisor. Every component starts without a colouring.
+  * @param graph the shared graph
+  * @return 0 on success, -1 on failure
+**/
+int create_solution(const struct Graph *graph);
+
+/**
+  * Open Solution function
+  * @brief Attach to the solution segment of the supervisor
+  * @param graph the shared graph
+  * @return 0 on success, -1 if there is no solution segment
+**/
+int open_solution(const struct Graph *graph);
+
+/**
+  * Close Solution function
+  * @brief Unmap the solution segment
+  * @details Does nothing if no segment is mapped.
+  * @param isSupervisor the supervisor also unlinks the segment
+**/
+void close_solution(bool isSupervisor);
+
+/**
+  * Offer Solution function
+  * @brief Store the colouring of a component if it is better than the stored one
+  * @details Used by the generators before they publish the result.
+  * Does nothing if no segment is mapped.
+  * @param graph the shared graph
+  * @param component the component
+  * @param colours colour of every vertex
+  * @param amount number of removed edges of the colouring
+**/
+void offer_solution(const struct Graph *graph, int component, const unsigned char *colours, int amount);
+
+/**
+  * Read Solution function
+  * @brief Copy the stored colouring of a component
+  * @details Used by the supervisor, gives up if a generator keeps writing the slot.
+  * @param graph the shared graph
+  * @param component the component
+  * @param colours the colours of the component's vertices are stored here
+  * @return the amount of the colouring, INT_MAX if there is none, -1 if it couldn't be read
+**/
+int read_solution(const struct Graph *graph, int component, unsigned char *colours);
+
+/**
+  * Write Checkpoint function
+  * @brief Save a colouring atomically
+  * @details The colouring is written to a temporary file which replaces path once
+  * it is on disk, so path always holds a complete checkpoint.
+  * @param path path of the checkpoint
+  * @param graph the graph
+  * @param colours colour of every vertex
+  * @param k number of colours
+  * @param amount number of removed edges of the colouring
+  * @return 0 on success, -1 on failure
+**/
+int write_checkpoint(const char *path, const struct Graph *graph, const unsigned char *colours, int k, int amount);
+
+/**
+  * Load Checkpoint function
+  * @brief Load a colouring saved by write_checkpoint
+  * @details Vertices missing in the checkpoint keep their colour. Colours of a
+  * checkpoint with more colours are wrapped around to k.
+  * @param path path of the checkpoint
+  * @param graph the graph
+  * @param colours colour of every vertex
+  * @param k number of colours
+  * @return 0 on success, -1 on failure (errno is ENOENT if there is no checkpoint)
+**/
+int load_checkpoint(const char *path, const struct Graph *graph, unsigned char *colours, int k);
+
+#endif
@@ -0,0 +1,152 @@
+/**
+  * @file stats.c
+  * @author
+  * @date 13.11.2022
+  * @brief Implementation of stats.h
+**/
+
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+
+#include "circularBuffer.h"
+#include "stats.h"
+
+//File the counters are dumped to
+static FILE *dump = NULL;
+
+
+/**
+  * Active Slot function
+  * @brief Check if a statistics slot belongs to a running generator
+  * @details A slot of a generator which no longer exists is freed.
+  * @param stats the slot
+  * @return the pid of the generator or 0
+**/
+static pid_t active_slot(struct GeneratorStats *stats){
+    pid_t pid = __atomic_load_n(&stats->pid, __ATOMIC_ACQUIRE);
+
+    if(pid != 0 && kill(pid, 0) == -1 && errno == ESRCH){
+        __atomic_compare_exchange_n(&stats->pid, &pid, 0, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+        return 0;
+    }
+    return pid;
+}
+
+/**
+  * Occupancy function
+  * @brief Number of results waiting in the buffer
+**/
+static int occupancy(void){
+    int value = 0;
+    sem_getvalue(use_sem, &value);
+    return value;
+}
+
+void take_snapshot(struct StatsSnapshot *snapshot, double elapsed){
+    struct StatsSnapshot sum = {.elapsed = elapsed};
+
+    for(int i = 0; i < MAX_GENERATORS; i++){
+        struct GeneratorStats *stats = &buffer->generator_stats[i];
+        if(active_slot(stats) == 0){
+            continue;
+        }
+        sum.generators++;
+        sum.attempts += STAT_GET(stats->attempts);
+        sum.published += STAT_GET(stats->published);
+        sum.filtered += STAT_GET(stats->filtered);
+        sum.write_wait_ns += STAT_GET(stats->write_wait_ns);
+        sum.free_wait_ns += STAT_GET(stats->free_wait_ns);
+    }
+
+    sum.drained = STAT_GET(buffer->supervisor_stats.drained);
+    sum.occupancy = occupancy();
+    *snapshot = sum;
+}
+
+/**
+  * Delta function
+  * @brief Difference of two counters
+  * @details Counters of exited generators disappear from the sum, so the difference
+  * is never allowed to become negative.
+**/
+static unsigned long long delta(unsigned long long now, unsigned long long before){
+    return now > before ? now - before : 0;
+}
+
+void print_stats(FILE *out, const struct StatsSnapshot *now, const struct StatsSnapshot *before){
+    double seconds = now->elapsed - before->elapsed;
+    if(seconds <= 0){
+        seconds = 1;
+    }
+
+    int best = get_best();
+
+    fprintf(out, "stats t=%.1fs generators=%d attempts/s=%.0f published=%llu filtered=%llu "
+        "write_wait=%.1fms free_wait=%.1fms drained/s=%.0f ring=%d/%d best=",
+        now->elapsed, now->generators,
+        delta(now->attempts, before->attempts) / seconds,
+        delta(now->published, before->published),
+        delta(now->filtered, before->filtered),
+        delta(now->write_wait_ns, before->write_wait_ns) / 1e6,
+        delta(now->free_wait_ns, before->free_wait_ns) / 1e6,
+        delta(now->drained, before->drained) / seconds,
+        now->occupancy, BUFFER_SIZE);
+
+    if(best == INT_MAX){
+        fprintf(out, "-\n");
+    }
+    else{
+        fprintf(out, "%d\n", best);
+    }
+    fflush(out);
+}
+
+int open_stats_dump(const char *path){
+    dump = fopen(path, "w");
+    if(dump == NULL){
+        return -1;
+    }
+
+    fprintf(dump, "time,role,slot,pid,attempts,published,filtered,write_wait_ns,free_wait_ns,drained,occupancy,best,best_time\n");
+    fflush(dump);
+    return 0;
+}
+
+void dump_stats(double elapsed, double bestTime){
+    if(dump == NULL){
+        return;
+    }
+
+    for(int i = 0; i < MAX_GENERATORS; i++){
+        struct GeneratorStats *stats = &buffer->generator_stats[i];
+        pid_t pid = active_slot(stats);
+        if(pid == 0){
+            continue;
+        }
+        fprintf(dump, "%.3f,generator,%d,%d,%llu,%llu,%llu,%llu,%llu,,,,\n", elapsed, i, (int)pid,
+            STAT_GET(stats->attempts), STAT_GET(stats->published), STAT_GET(stats->filtered),
+            STAT_GET(stats->write_wait_ns), STAT_GET(stats->free_wait_ns));
+    }
+
+    int best = get_best();
+    fprintf(dump, "%.3f,supervisor,,%d,,,,,,%llu,%d,", elapsed, (int)getpid(),
+        STAT_GET(buffer->supervisor_stats.drained), occupancy());
+    if(best != INT_MAX){
+        fprintf(dump, "%d", best);
+    }
+    fprintf(dump, ",");
+    if(bestTime >= 0){
+        fprintf(dump, "%.3f", bestTime);
+    }
+    fprintf(dump, "\n");
+    fflush(dump);
+}
+
+void close_stats_dump(void){
+    if(dump != NULL){
+        fclose(dump);
+        dump = NULL;
+    }
+}
@@ -0,0 +1,79 @@
+/**
+  * @file stats.h
+  * @author
+  * @date 13.11.2022
+  * @brief The module for reading the counters in the shared buffer.
+  * @details Used by the supervisor to print a compact stats line and to dump
+  * the counters of every generator in machine-readable form.
+**/
+#include <stdio.h>
+
+
+#ifndef STATS_H
+#define STATS_H
+
+
+/**
+  * Structure for the stats snapshot
+  * @brief The counters of all generators and the supervisor at one point of time
+  * @details elapsed is the time in seconds since the supervisor started.
+**/
+struct StatsSnapshot{
+    double elapsed;
+    int generators;
+    unsigned long long attempts;
+    unsigned long long published;
+    unsigned long long filtered;
+    unsigned long long write_wait_ns;
+    unsigned long long free_wait_ns;
+    unsigned long long drained;
+    int occupancy;
+};
+
+
+/**
+  * Take Snapshot function
+  * @brief Sum up the counters in the shared buffer
+  * @details Slots of generators which died without releasing them are freed.
+  * @param snapshot the sums are stored here
+  * @param elapsed seconds since the supervisor started
+**/
+void take_snapshot(struct StatsSnapshot *snapshot, double elapsed);
+
+/**
+  * Print Stats function
+  * @brief Print one stats line
+  * @details Rates and wait times are computed for the time between the two snapshots.
+  * @param out the stream to print to
+  * @param now the current snapshot
+  * @param before the previous snapshot
+**/
+void print_stats(FILE *out, const struct StatsSnapshot *now, const struct StatsSnapshot *before);
+
+/**
+  * Open Stats Dump function
+  * @brief Open the file the counters are dumped to
+  * @details The file is truncated and gets a CSV header.
+  * @param path path of the file
+  * @return 0 on success, -1 on failure
+**/
+int open_stats_dump(const char *path);
+
+/**
+  * Dump Stats function
+  * @brief Append the counters as CSV rows
+  * @details One row for every generator and one for the supervisor.
+  * Does nothing if no dump file is open.
+  * @param elapsed seconds since the supervisor started
+  * @param bestTime seconds since the supervisor started when the best solution was found,
+  * negative while there is none
+**/
+void dump_stats(double elapsed, double bestTime);
+
+/**
+  * Close Stats Dump function
+  * @brief Close the dump file
+**/
+void close_stats_dump(void);
+
+#endif
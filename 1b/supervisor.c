@@ -5,6 +5,8 @@
 
   * @brief The supervisor module
   * @details The supervisor reads from the shared memory the results.
+  * If a graph file is given, it is loaded once and shared with the generators,
+  * which the supervisor can also start and supervise itself.
 **/
 
 #include <signal.h>
@@ -13,8 +15,17 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
 
 #include "circularBuffer.h"
+#include "graph.h"
+#include "pool.h"
+#include "stats.h"
+#include "colouring.h"
+#include "solution.h"
 
 char *progname;
 
@@ -27,7 +38,20 @@ volatile sig_atomic_t quit = 0;
   * exit on EXIT_FAILURE
 **/
 void usage(void){
-    fprintf(stderr, "Usage: %s doesn't require any arguments\n", progname);
+    fprintf(stderr, "Usage: %s [-I ID] [-n N] [-k K] [-H] [-o FILE] [-w FILE] [-t SECONDS] [-q TARGET] [-s INTERVAL] [-D FILE] [GRAPH]\n"
+        "       %s -C\n"
+        "-I ID runs instance ID, so several solves can run at the same time.\n"
+        "-C removes the shared objects of every instance whose supervisor is gone.\n"
+        "GRAPH is an edge list or DIMACS .col file shared with the generators.\n"
+        "-n N starts N generators, 1 to %d, pinned to their own cores (requires GRAPH).\n"
+        "-k K colours with K colours, 2 to 64 (default 3).\n"
+        "-H backs the buffer and the graph with huge pages if available.\n"
+        "-o FILE saves the best colouring to FILE whenever it improves (requires GRAPH).\n"
+        "-w FILE warm-starts the generators from the checkpoint FILE (requires -n).\n"
+        "-t SECONDS stops the solve after SECONDS.\n"
+        "-q TARGET stops once a solution removes at most TARGET edges.\n"
+        "-s INTERVAL prints a stats line to stderr every INTERVAL seconds.\n"
+        "-D FILE dumps the counters as CSV to FILE (every interval and on exit).\n", progname, progname, MAX_GENERATORS);
     exit(EXIT_FAILURE);
 }
 
@@ -39,13 +63,217 @@ void usage(void){
 **/
 void handle_signal(int signal) { quit = 1; }
 
+/**
+  * Handle Child function
+  * @brief used for sa.sa_handler of SIGCHLD.
+  * @details Does nothing, the signal only interrupts the wait for results
+  * so exited generators are reaped.
+  * @param signal 
+**/
+void handle_child(int signal) { }
+
+/**
+  * Parse Count function
+  * @brief Parse the number of generators
+  * @details Every generator needs its own statistics slot, so at most MAX_GENERATORS.
+  * @param arg the option argument
+  * @return the number, exits with usage on a wrong number
+**/
+int parse_count(const char *arg){
+    char *endptr;
+    errno = 0;
+    long count = strtol(arg, &endptr, 10);
+
+    if(errno != 0 || endptr == arg || *endptr != '\0' || count < 1 || count > MAX_GENERATORS){
+        usage();
+    }
+    return (int)count;
+}
+
+/**
+  * Parse Seconds function
+  * @brief Parse the stats interval or the time limit
+  * @param arg the option argument
+  * @return the seconds, exits with usage on a wrong number
+**/
+double parse_seconds(const char *arg){
+    char *endptr;
+    errno = 0;
+    double seconds = strtod(arg, &endptr);
+
+    if(errno != 0 || endptr == arg || *endptr != '\0' || !(seconds >= 0.01 && seconds <= 1e7)){
+        usage();
+    }
+    return seconds;
+}
+
+/**
+  * Parse Amount function
+  * @brief Parse the target amount of removed edges
+  * @param arg the option argument
+  * @return the amount, exits with usage on a wrong number
+**/
+int parse_amount(const char *arg){
+    char *endptr;
+    errno = 0;
+    long amount = strtol(arg, &endptr, 10);
+
+    if(errno != 0 || endptr == arg || *endptr != '\0' || amount < 0 || amount >= INT_MAX){
+        usage();
+    }
+    return (int)amount;
+}
+
+/**
+  * Parse Colours function
+  * @brief Parse the number of colours
+  * @param arg the option argument
+  * @return the number, exits with usage on a wrong number
+**/
+int parse_colours(const char *arg){
+    char *endptr;
+    errno = 0;
+    long colours = strtol(arg, &endptr, 10);
+
+    if(errno != 0 || endptr == arg || *endptr != '\0' || colours < MIN_COLOURS || colours > MAX_COLOURS){
+        usage();
+    }
+    return (int)colours;
+}
+
+/**
+  * Timespec Reached function
+  * @brief Check if a CLOCK_REALTIME deadline has passed
+  * @param deadline the deadline
+  * @return true if it has passed
+**/
+bool timespec_reached(const struct timespec *deadline){
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return now.tv_sec > deadline->tv_sec || (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+}
+
+/**
+  * Earlier Deadline function
+  * @brief The earlier of two optional deadlines
+  * @param a deadline or NULL
+  * @param b deadline or NULL
+  * @return the earlier one, NULL if both are NULL
+**/
+const struct timespec *earlier_deadline(const struct timespec *a, const struct timespec *b){
+    if(a == NULL){
+        return b;
+    }
+    if(b == NULL){
+        return a;
+    }
+    return (a->tv_sec < b->tv_sec || (a->tv_sec == b->tv_sec && a->tv_nsec <= b->tv_nsec)) ? a : b;
+}
+
+/**
+  * Monotonic Seconds function
+  * @brief Seconds on the monotonic clock
+**/
+double monotonic_seconds(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+  * Deadline After function
+  * @brief Absolute CLOCK_REALTIME time some seconds from now, as used by read_from_buffer
+  * @param seconds the seconds
+  * @param deadline the time is stored here
+**/
+void deadline_after(double seconds, struct timespec *deadline){
+    clock_gettime(CLOCK_REALTIME, deadline);
+    long long nanoseconds = deadline->tv_nsec + (long long)(seconds * 1e9);
+    deadline->tv_sec += nanoseconds / 1000000000LL;
+    deadline->tv_nsec = nanoseconds % 1000000000LL;
+}
+
+/**
+  * Merged Amount function
+  * @brief Amount of the solution merged from the components
+  * @param results best result of every component
+  * @param count number of components
+  * @return the sum of the amounts, INT_MAX while a component has no result
+**/
+int merged_amount(const struct Result *results, int count){
+    long amount = 0;
+    for(int i = 0; i < count; i++){
+        if(results[i].amount == INT_MAX){
+            return INT_MAX;
+        }
+        amount += results[i].amount;
+    }
+    return amount < INT_MAX ? (int)amount : INT_MAX - 1;
+}
+
+/**
+  * Valid Checkpoint function
+  * @brief Check if the generators can warm-start from a checkpoint
+  * @param path path of the checkpoint
+  * @param graph the shared graph
+  * @return true if the checkpoint matches the graph or doesn't exist yet
+**/
+bool valid_checkpoint(const char *path, const struct Graph *graph){
+    unsigned char *colours = calloc(graph->vertex_count > 0 ? graph->vertex_count : 1, 1);
+    if(colours == NULL){
+        return false;
+    }
+    bool valid = load_checkpoint(path, graph, colours, MAX_COLOURS) == 0 || errno == ENOENT;
+    free(colours);
+    return valid;
+}
+
+/**
+  * Save Checkpoint function
+  * @brief Save the best colouring after a component improved
+  * @details The colouring of the component is taken from the solution segment,
+  * it may already be better than the result read from the buffer.
+  * The checkpoint is only written once every component has a colouring and
+  * whenever the merged colouring improves.
+  * @param path path of the checkpoint
+  * @param graph the shared graph
+  * @param component the improved component
+  * @param colours colour of every vertex in the checkpoint
+  * @param amounts amount of every component in the checkpoint
+  * @param saved amount of the saved checkpoint
+  * @param k number of colours
+**/
+void save_checkpoint(const char *path, const struct Graph *graph, int component, unsigned char *colours,
+    int *amounts, int *saved, int k){
+    //On -1 the colours of the component may be torn
+    int amount = read_solution(graph, component, colours);
+    amounts[component] = amount != -1 ? amount : INT_MAX;
+
+    int merged = 0;
+    for(int i = 0; i < graph->component_count; i++){
+        if(amounts[i] == INT_MAX){
+            return;
+        }
+        merged += amounts[i];
+    }
+    if(merged >= *saved){
+        return;
+    }
+
+    if(write_checkpoint(path, graph, colours, k, merged) == -1){
+        fprintf(stderr, "Couldn't write the checkpoint %s. \n", path);
+        return;
+    }
+    *saved = merged;
+}
+
 /**
   * Main function
   * @brief entry point to the program
   * @details The supervisor reads from the shared memeory and
-  * if the current result is worse than the better result,
-  * then the current result becomes the better result and
-  * it is printed out. If the graph is 3 colourable, 
+  * if the current result is better than the better result of its component,
+  * then the current result becomes the better result. Once every component
+  * has a result, the merged solution is printed out whenever it improves. If the graph is k colourable, 
   * the supervisor tells that and ends the program with
   * EXIT_SUCCESS.
   * @param argc
@@ -56,10 +284,128 @@ int main(int argc, char **argv){
     bool isSupervisor = true;
     progname = argv[0];
 
-   
-    if(argc > 1){
+    int generatorCount = 0;
+    double interval = 0;
+    double timeLimit = 0;
+    int target = -1;
+    int colours = 0;
+    char *dumpFile = NULL;
+    char *checkpointFile = NULL;
+    char *warmFile = NULL;
+    char *instance = NULL;
+    bool cleanup = false;
+    bool hugePages = false;
+    int c = 0;
+
+    while((c = getopt(argc, argv, "I:Cn:k:Ho:w:s:D:t:q:")) != -1){
+        switch (c){
+            case 'I':
+                if(instance != NULL || set_instance(optarg) == -1){
+                    usage();
+                }
+                instance = optarg;
+                break;
+            case 'C':
+                cleanup = true;
+                break;
+            case 'n':
+                if(generatorCount != 0){
+                    usage();
+                }
+                generatorCount = parse_count(optarg);
+                break;
+            case 's':
+                if(interval != 0){
+                    usage();
+                }
+                interval = parse_seconds(optarg);
+                break;
+            case 'k':
+                if(colours != 0){
+                    usage();
+                }
+                colours = parse_colours(optarg);
+                break;
+            case 'H':
+                hugePages = true;
+                break;
+            case 'o':
+                if(checkpointFile != NULL){
+                    usage();
+                }
+                checkpointFile = optarg;
+                break;
+            case 'w':
+                if(warmFile != NULL){
+                    usage();
+                }
+                warmFile = optarg;
+                break;
+            case 't':
+                if(timeLimit != 0){
+                    usage();
+                }
+                timeLimit = parse_seconds(optarg);
+                break;
+            case 'q':
+                if(target != -1){
+                    usage();
+                }
+                target = parse_amount(optarg);
+                break;
+            case 'D':
+                if(dumpFile != NULL){
+                    usage();
+                }
+                dumpFile = optarg;
+                break;
+            default:
+                usage();
+                break;
+        }
+    }
+
+    if(argc - optind > 1 || (generatorCount > 0 && argc - optind != 1)){
         usage();
     }
+    char *graphFile = optind < argc ? argv[optind] : NULL;
+    if((checkpointFile != NULL && graphFile == NULL) || (warmFile != NULL && generatorCount == 0)){
+        usage();
+    }
+
+    if(cleanup){
+        if(instance != NULL || generatorCount > 0 || colours != 0 || hugePages || interval != 0 || timeLimit != 0 || target != -1
+            || dumpFile != NULL || checkpointFile != NULL || warmFile != NULL || graphFile != NULL){
+            usage();
+        }
+        int removed = remove_stale_instances();
+        if(removed == -1){
+            failed_exit("Couldn't read /dev/shm. \n");
+        }
+        fprintf(stdout, "Removed %d stale instance(s). \n", removed);
+        exit(EXIT_SUCCESS);
+    }
+
+    struct RawGraph raw;
+    if(graphFile != NULL){
+        if(load_graph_file(graphFile, &raw) == -1 || prepare_graph(&raw) == -1 || split_components(&raw) == -1){
+            failed_exit("Couldn't load the graph. \n");
+        }
+    }
+
+    char *generatorArgs[6] = {NULL};
+    int generatorArgCount = 1;
+    if(instance != NULL){
+        generatorArgs[generatorArgCount++] = "-I";
+        generatorArgs[generatorArgCount++] = instance;
+    }
+    if(warmFile != NULL){
+        generatorArgs[generatorArgCount++] = "-w";
+        generatorArgs[generatorArgCount++] = warmFile;
+    }
+    if(generatorCount > 0 && (generatorArgs[0] = generator_path(progname)) == NULL){
+        failed_exit("Malloc failed. \n");
+    }
 
   
     //Signal Setup
@@ -70,33 +416,183 @@ int main(int argc, char **argv){
     sigaction(SIGINT, &sa, 0);
     //kill command
     sigaction(SIGTERM, &sa, 0);
+    //exited generators
+    sa.sa_handler = handle_child;
+    sigaction(SIGCHLD, &sa, 0);
     
     struct Result currentResult = {.amount = INT_MAX};
-    struct Result betterResult = currentResult;
+    struct Graph graph;
+    int componentCount = 1;
 
    //Open the buffer
+    if(hugePages){
+        use_huge_pages();
+    }
+    if(colours == 0){
+        colours = 3;
+    }
+    set_colours(colours);
     open_buffer(isSupervisor);
 
+    //Share the graph with the generators
+    if(graphFile != NULL){
+        if(publish_graph(&raw, &graph) == -1){
+            close_buffer(isSupervisor);
+            failed_exit("Couldn't share the graph. \n");
+        }
+        free_raw_graph(&raw);
+        if(create_solution(&graph) == -1){
+            close_buffer(isSupervisor);
+            failed_exit("Couldn't create the solution segment. \n");
+        }
+        componentCount = graph.component_count;
+
+        //A broken checkpoint would only make the generators exit again and again
+        if(warmFile != NULL && !valid_checkpoint(warmFile, &graph)){
+            close_buffer(isSupervisor);
+            fprintf(stderr, "%s is not a checkpoint of the graph. \n", warmFile);
+            exit(EXIT_FAILURE);
+        }
+        fprintf(stdout, "Shared graph with %d vertices, %d edges and %d component(s). \n",
+            graph.vertex_count, graph.edge_count, componentCount);
+    }
+
+    //Best result of every component
+    struct Result *betterResults = malloc(sizeof(struct Result) * componentCount);
+    if(betterResults == NULL){
+        close_buffer(isSupervisor);
+        failed_exit("Malloc failed. \n");
+    }
+    for(int i = 0; i < componentCount; i++){
+        betterResults[i].amount = INT_MAX;
+    }
+    int betterAmount = INT_MAX;
+    double bestTime = -1;
+
+    //The colouring saved to the checkpoint and the amount of every component in it
+    unsigned char *checkpointColours = NULL;
+    int *checkpointAmounts = NULL;
+    int checkpointAmount = INT_MAX;
+    if(checkpointFile != NULL){
+        checkpointColours = calloc(graph.vertex_count, 1);
+        checkpointAmounts = malloc(sizeof(int) * componentCount);
+        if(checkpointColours == NULL || checkpointAmounts == NULL){
+            close_buffer(isSupervisor);
+            failed_exit("Malloc failed. \n");
+        }
+        for(int i = 0; i < componentCount; i++){
+            checkpointAmounts[i] = INT_MAX;
+        }
+    }
+
+    if(dumpFile != NULL && open_stats_dump(dumpFile) == -1){
+        fprintf(stderr, "Couldn't open %s, not dumping stats. \n", dumpFile);
+    }
+
+    fprintf(stdout, "Colouring with k=%d colours. \n", colours);
+
+    set_generator_count(generatorCount);
+    if(generatorCount > 0 && start_pool(generatorCount, generatorArgs) == -1){
+        fprintf(stderr, "Couldn't start the generators. \n");
+        quit = 1;
+    }
+
+    double start = monotonic_seconds();
+    struct StatsSnapshot lastSnapshot;
+    take_snapshot(&lastSnapshot, 0);
+
+    struct timespec nextReport;
+    if(interval > 0){
+        deadline_after(interval, &nextReport);
+    }
+
+    struct timespec endTime;
+    if(timeLimit > 0){
+        deadline_after(timeLimit, &endTime);
+    }
     
     while(!quit){
-        read_from_buffer(&currentResult);
+        const struct timespec *deadline = earlier_deadline(interval > 0 ? &nextReport : NULL,
+            timeLimit > 0 ? &endTime : NULL);
+        int ret = read_from_buffer(&currentResult, deadline);
+
+        if(interval > 0 && timespec_reached(&nextReport)){
+            struct StatsSnapshot snapshot;
+            take_snapshot(&snapshot, monotonic_seconds() - start);
+            print_stats(stderr, &snapshot, &lastSnapshot);
+            dump_stats(snapshot.elapsed, bestTime);
+            lastSnapshot = snapshot;
+            deadline_after(interval, &nextReport);
+        }
+
+        if(timeLimit > 0 && timespec_reached(&endTime)){
+            fprintf(stdout, "Time limit reached. \n");
+            break;
+        }
+
+        if(ret == -1){
+            //Generators killed on the way to shutdown mustn't be restarted
+            if(quit){
+                break;
+            }
+            if(generatorCount > 0 && reap_pool(true) == 0){
+                fprintf(stderr, "All generators exited. \n");
+                break;
+            }
+            continue;
+        }
         
-        //Graph is 3 colourable
-        if(currentResult.amount == 0){
-            fprintf(stdout,"The given graph is 3-Colourable. \n");
+        int component = currentResult.component;
+        if(component < 0 || component >= componentCount || currentResult.amount >= betterResults[component].amount){
+            continue;
+        }
+
+        //better result for the component, generators of the component drop worse ones
+        betterResults[component] = currentResult;
+        if(graphFile != NULL){
+            __atomic_store_n(&graph.component_best[component], currentResult.amount, __ATOMIC_RELAXED);
+        }
+        if(checkpointFile != NULL){
+            save_checkpoint(checkpointFile, &graph, component, checkpointColours, checkpointAmounts,
+                &checkpointAmount, colours);
+        }
+
+        int amount = merged_amount(betterResults, componentCount);
+        if(amount >= betterAmount){
+            continue;
+        }
+        betterAmount = amount;
+        bestTime = monotonic_seconds() - start;
+        set_best(amount);
+
+        //Graph is k colourable
+        if(amount == 0){
+            fprintf(stdout,"The given graph is %d-Colourable. \n", colours);
             break;
         }
         
         //better result found
-        if(currentResult.amount < betterResult.amount ){
-            betterResult = currentResult;
-            print_result(&betterResult);
+        print_results(betterResults, componentCount);
+
+        if(amount <= target){
+            fprintf(stdout, "Target of %d removed edges(s) reached. \n", target);
+            break;
         }
     }
 
+    dump_stats(monotonic_seconds() - start, bestTime);
+    close_stats_dump();
 
-    clean_exit(isSupervisor);
-
-}
+    //No generator may touch the buffer while it is removed
+    stop_generators();
+    if(generatorCount > 0){
+        stop_pool();
+        free(generatorArgs[0]);
+    }
 
+    free(betterResults);
+    free(checkpointColours);
+    free(checkpointAmounts);
+    clean_exit(isSupervisor);
 
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+/**
+  * @file batch.c
+  * @author
+  * @date 11.12.2022
+  * @brief Implementation of batch.h
+*/
+
+#include "batch.h"
+#include "fft.h"
+#include "input.h"
+#include "output.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+
+/**
+  * Fail function
+  * @brief stops all stages
+  * @param batch the batch
+  * @param msg the message of the error, only the first one is kept
+*/
+static void fail(batch_t *batch, const char *msg){
+    pthread_mutex_lock(&batch->lock);
+    if(batch->error == NULL){
+        batch->error = msg;
+    }
+    pthread_cond_broadcast(&batch->changed);
+    pthread_mutex_unlock(&batch->lock);
+}
+
+/**
+  * Push frame function
+  * @brief passes a frame to the next stage
+  * @details Waits while the queue is full.
+  * @return false if the batch was stopped, the frame wasn't passed
+*/
+static bool push_frame(batch_t *batch, frameQueue_t *queue, batchFrame_t frame){
+    pthread_mutex_lock(&batch->lock);
+    while(queue->count == BATCH_DEPTH && batch->error == NULL){
+        pthread_cond_wait(&batch->changed, &batch->lock);
+    }
+    bool pushed = batch->error == NULL;
+    if(pushed){
+        queue->frames[(queue->head + queue->count) % BATCH_DEPTH] = frame;
+        queue->count++;
+        pthread_cond_broadcast(&batch->changed);
+    }
+    pthread_mutex_unlock(&batch->lock);
+    return pushed;
+}
+
+/**
+  * Pop frame function
+  * @brief takes a frame from the previous stage
+  * @details Waits while the queue is empty.
+  * @param last set if no further frame is waiting
+  * @return false if the batch was stopped
+*/
+static bool pop_frame(batch_t *batch, frameQueue_t *queue, batchFrame_t *frame, bool *last){
+    pthread_mutex_lock(&batch->lock);
+    while(queue->count == 0 && batch->error == NULL){
+        pthread_cond_wait(&batch->changed, &batch->lock);
+    }
+    bool popped = batch->error == NULL;
+    if(popped){
+        *frame = queue->frames[queue->head];
+        queue->head = (queue->head + 1) % BATCH_DEPTH;
+        queue->count--;
+        *last = queue->count == 0;
+        pthread_cond_broadcast(&batch->changed);
+    }
+    pthread_mutex_unlock(&batch->lock);
+    return popped;
+}
+
+/**
+  * Transform stage function
+  * @brief transforms the parsed frames
+  * @details Plans are only computed here, the cached plan of a size is used for all its frames.
+*/
+static void *transform_stage(void *argument){
+    batch_t *batch = argument;
+    batchFrame_t frame;
+    bool last;
+
+    while(pop_frame(batch, &batch->parsed, &frame, &last)){
+        if(frame.numbers != NULL){
+            const fftPlan_t *plan = get_plan(frame.size);
+            if(plan == NULL || fft(plan, frame.numbers) == -1){
+                free(frame.numbers);
+                fail(batch, "Malloc failed");
+                break;
+            }
+        }
+        if(!push_frame(batch, &batch->transformed, frame)){
+            free(frame.numbers);
+            break;
+        }
+        if(frame.numbers == NULL){
+            break;
+        }
+    }
+    return NULL;
+}
+
+/**
+  * Write stage function
+  * @brief writes the transformed frames
+  * @details The output is flushed whenever no further frame is waiting,
+  * so a reader of the output gets every frame as soon as it is done.
+*/
+static void *write_stage(void *argument){
+    static output_t output = {.fd = STDOUT_FILENO};
+    batch_t *batch = argument;
+    batchFrame_t frame;
+    bool last;
+
+    while(pop_frame(batch, &batch->transformed, &frame, &last)){
+        if(frame.numbers == NULL){
+            if(flush_output(&output) == -1){
+                fail(batch, "Write failed");
+            }
+            break;
+        }
+
+        bool failed = false;
+        for(int i = 0; i < frame.size && !failed; i++){
+            failed = write_result(&output, batch->rounded, frame.numbers[i]) == -1;
+        }
+        free(frame.numbers);
+        failed = failed || write_separator(&output) == -1 || (last && flush_output(&output) == -1);
+        if(failed){
+            fail(batch, "Write failed");
+            break;
+        }
+    }
+    return NULL;
+}
+
+/**
+  * Free queue function
+  * @brief frees the frames left in a queue after an error
+*/
+static void free_queue(frameQueue_t *queue){
+    for(; queue->count > 0; queue->count--){
+        free(queue->frames[queue->head].numbers);
+        queue->head = (queue->head + 1) % BATCH_DEPTH;
+    }
+}
+
+const char *run_batch(bool rounded){
+    batch_t batch = {.rounded = rounded, .error = NULL};
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_cond_init(&batch.changed, NULL);
+
+    input_t input;
+    if(open_input(&input, STDIN_FILENO) == -1){
+        return "Malloc failed";
+    }
+
+    pthread_t transformer;
+    pthread_t writer;
+    if(pthread_create(&transformer, NULL, transform_stage, &batch) != 0){
+        close_input(&input);
+        return "Thread creation failed";
+    }
+    if(pthread_create(&writer, NULL, write_stage, &batch) != 0){
+        fail(&batch, "Thread creation failed");
+        pthread_join(transformer, NULL);
+        close_input(&input);
+        return batch.error;
+    }
+
+    //This thread reads
+    for(int frames = 0; ; frames++){
+        batchFrame_t frame = {NULL, 0};
+        inputError_t error = read_batch(&input, &frame.numbers, &frame.size);
+        if(error != INPUT_OK && error != INPUT_END){
+            fail(&batch, input_error_message(error));
+            break;
+        }
+        //Empty input is an error like for a single transform
+        if(error == INPUT_END && frames == 0){
+            fail(&batch, "Wrong input size");
+            break;
+        }
+        if(!push_frame(&batch, &batch.parsed, frame)){
+            free(frame.numbers);
+            break;
+        }
+        if(error == INPUT_END){
+            break;
+        }
+    }
+
+    pthread_join(transformer, NULL);
+    pthread_join(writer, NULL);
+    close_input(&input);
+    free_queue(&batch.parsed);
+    free_queue(&batch.transformed);
+    pthread_cond_destroy(&batch.changed);
+    pthread_mutex_destroy(&batch.lock);
+    return batch.error;
+}
@@ -0,0 +1,68 @@
+/**
+  * @file batch.h
+  * @author
+  * @date 11.12.2022
+
+  * @brief Header file for transforming many frames in one run
+  * @details The frames of the input are separated by blank lines, every
+  * frame is transformed on its own and its results are followed by a blank
+  * line. Reading, transforming and writing run in their own threads, so
+  * frame i+1 is parsed while frame i is transformed and frame i-1 written.
+*/
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "forkFFT.h"
+
+
+//Frames waiting between two stages
+#define BATCH_DEPTH 4
+
+
+/**
+  * Structure for batch frames
+  * @brief A frame passed between the stages
+  * @details numbers is NULL for the frame after the last one.
+*/
+typedef struct BatchFrame{
+    comNum_t *numbers;
+    int size;
+} batchFrame_t;
+
+/**
+  * Structure for frame queues
+  * @brief The frames between two stages
+*/
+typedef struct FrameQueue{
+    batchFrame_t frames[BATCH_DEPTH];
+    int head;
+    int count;
+} frameQueue_t;
+
+/**
+  * Structure for batches
+  * @brief The state shared by the stages
+  * @details error is the first error of any stage, the others stop once it is set.
+*/
+typedef struct Batch{
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    frameQueue_t parsed;
+    frameQueue_t transformed;
+    bool rounded;
+    const char *error;
+} batch_t;
+
+
+/**
+  * Run batch function
+  * @brief transforms all frames of stdin and writes them to stdout
+  * @param rounded round the results to 3 digits
+  * @return NULL on success, the message of the error otherwise
+*/
+const char *run_batch(bool rounded);
+
+#endif
@@ -0,0 +1,141 @@
+/**
+  * @file convolve.c
+  * @author
+  * @date 11.12.2022
+  * @brief Implementation of convolve.h
+*/
+
+#include "convolve.h"
+#include "fft.h"
+#include "input.h"
+#include "output.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/**
+  * Read numbers of function
+  * @brief reads all numbers of a file descriptor
+  * @param fd the file descriptor
+  * @param numbers the buffer is stored here, free it with free
+  * @param size number of numbers is stored here
+  * @return NULL on success, the message of the error otherwise
+*/
+static const char *read_numbers_of(int fd, comNum_t **numbers, int *size){
+    inputError_t error = read_input(fd, numbers, size);
+    if(error != INPUT_OK){
+        return input_error_message(error);
+    }
+    if(*size == 0){
+        free(*numbers);
+        return "Wrong input size";
+    }
+    return NULL;
+}
+
+/**
+  * Pad function
+  * @brief copies numbers into a buffer of the transform length
+  * @param numbers the numbers, freed
+  * @param size number of numbers
+  * @param length length of the transform
+  * @param reverse store the numbers conjugated in reversed order
+  * @return the buffer, NULL if the memory couldn't be allocated
+*/
+static comNum_t *pad(comNum_t *numbers, int size, int length, bool reverse){
+    comNum_t *padded = alloc_numbers(length);
+    if(padded != NULL){
+        if(reverse){
+            for(int n = 0; n < size; n++){
+                padded[n].real = numbers[size - 1 - n].real;
+                padded[n].imaginery = 0 - numbers[size - 1 - n].imaginery;
+            }
+        }
+        else{
+            memcpy(padded, numbers, sizeof(comNum_t) * size);
+        }
+        memset(padded + size, 0, sizeof(comNum_t) * (length - size));
+    }
+    free(numbers);
+    return padded;
+}
+
+/**
+  * Convolve function
+  * @brief convolves two padded inputs
+  * @details The product of the transforms is stored in signal and transformed back.
+  * @param plan the plan of the length of both
+  * @param signal the signal, overwritten with the result
+  * @param kernel the kernel, overwritten with its transform
+  * @return NULL on success, the message of the error otherwise
+*/
+static const char *convolve(const fftPlan_t *plan, comNum_t *signal, comNum_t *kernel){
+    if(fft(plan, signal) == -1 || fft(plan, kernel) == -1){
+        return "Malloc failed";
+    }
+    for(int k = 0; k < plan->size; k++){
+        comNum_t product = {
+            signal[k].real * kernel[k].real - signal[k].imaginery * kernel[k].imaginery,
+            signal[k].real * kernel[k].imaginery + signal[k].imaginery * kernel[k].real
+        };
+        signal[k] = product;
+    }
+    if(ifft(plan, signal) == -1){
+        return "Malloc failed";
+    }
+    return NULL;
+}
+
+const char *run_convolution(const char *path, bool correlate, bool rounded){
+    static output_t output = {.fd = STDOUT_FILENO};
+
+    int fd = open(path, O_RDONLY);
+    if(fd == -1){
+        return "Open failed";
+    }
+    comNum_t *kernel;
+    int kernelSize;
+    const char *msg = read_numbers_of(fd, &kernel, &kernelSize);
+    close(fd);
+    if(msg != NULL){
+        return msg;
+    }
+
+    comNum_t *signal;
+    int signalSize;
+    msg = read_numbers_of(STDIN_FILENO, &signal, &signalSize);
+    if(msg != NULL){
+        free(kernel);
+        return msg;
+    }
+
+    //Both are at most MAX_NUMBERS, so the length fits an int
+    int count = signalSize + kernelSize - 1;
+    int length = 1;
+    while(length < count){
+        length *= 2;
+    }
+
+    const fftPlan_t *plan = get_plan(length);
+    signal = pad(signal, signalSize, length, false);
+    kernel = pad(kernel, kernelSize, length, correlate);
+    msg = "Malloc failed";
+    if(plan != NULL && signal != NULL && kernel != NULL){
+        msg = convolve(plan, signal, kernel);
+    }
+
+    for(int j = 0; j < count && msg == NULL; j++){
+        if(write_result(&output, rounded, signal[j]) == -1){
+            msg = "Write failed";
+        }
+    }
+    if(msg == NULL && flush_output(&output) == -1){
+        msg = "Write failed";
+    }
+    free(signal);
+    free(kernel);
+    return msg;
+}
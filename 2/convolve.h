@@ -0,0 +1,33 @@
+/**
+  * @file convolve.h
+  * @author
+  * @date 11.12.2022
+
+  * @brief Header file for the fast convolution and cross-correlation
+  * @details The signal is read from stdin and the kernel from a file. Both are
+  * padded with zeros to a power of two of at least N+M-1, so the circular
+  * convolution of their transforms is the linear one. The forward transforms
+  * and the inverse all use the same plan.
+*/
+#ifndef CONVOLVE_H
+#define CONVOLVE_H
+
+#include <stdbool.h>
+
+#include "forkFFT.h"
+
+
+/**
+  * Run convolution function
+  * @brief convolves or correlates stdin with the numbers of a file
+  * @details The N+M-1 results are written to stdout. The convolution is
+  * y[j] = sum of x[n]*h[j-n]. The correlation is y[j] = sum of x[n+j-(M-1)]*conj(h[n]),
+  * so y[M-1] is the result without lag.
+  * @param path the file of the kernel h
+  * @param correlate correlate instead of convolve
+  * @param rounded round the results to 3 digits
+  * @return NULL on success, the message of the error otherwise
+*/
+const char *run_convolution(const char *path, bool correlate, bool rounded);
+
+#endif
@@ -0,0 +1,603 @@
+/**
+  * @file fft.c
+  * @author 
+  * @date 11.12.2022
+  * @brief Implementation of fft.h
+*/
+
+#include "fft.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86 1
+#endif
+
+//Cached plans, one per size
+static fftPlan_t *plans = NULL;
+
+/**
+  * Free plan function
+  * @brief frees one plan and its tables
+*/
+static void free_plan(fftPlan_t *plan){
+    free(plan->twiddles);
+    free(plan->real);
+    free(plan->imaginery);
+    free(plan->roots);
+    free(plan->chirp);
+    free(plan->kernelReal);
+    free(plan->kernelImaginery);
+    free(plan->untangle);
+    free(plan);
+}
+
+/**
+  * Factor function
+  * @brief splits a size into the radices of the mixed-radix transform
+  * @details 4 comes first, then 2, 3, 5 and 7.
+  * @param plan the plan, its factors are set
+  * @return true if no other prime factor is left
+*/
+static bool factor(fftPlan_t *plan){
+    static const int radices[] = {4, 2, 3, 5, 7};
+    int rest = plan->size;
+    plan->factorCount = 0;
+
+    for(int r = 0; r < (int)(sizeof(radices) / sizeof(radices[0])); r++){
+        while(rest % radices[r] == 0 && plan->factorCount < MAX_FACTORS){
+            plan->factors[plan->factorCount++] = radices[r];
+            rest /= radices[r];
+        }
+    }
+    return rest == 1;
+}
+
+/**
+  * Prepare Bluestein function
+  * @brief computes the tables of Bluestein's algorithm
+  * @details The chirp is w[n] = e^(-pi*i*n^2/size), the kernel is the transform
+  * of its conjugate wrapped around a power of two of at least 2*size-1.
+  * @return 0 on success, -1 if the memory couldn't be allocated
+*/
+static int prepare_bluestein(fftPlan_t *plan){
+    int size = plan->size;
+    int length = 1;
+    while(length < 2 * size - 1){
+        length *= 2;
+    }
+
+    plan->convolution = get_plan(length);
+    plan->chirp = malloc(sizeof(comNum_t) * size);
+    plan->kernelReal = calloc(length, sizeof(float));
+    plan->kernelImaginery = calloc(length, sizeof(float));
+    if(plan->convolution == NULL || plan->chirp == NULL || plan->kernelReal == NULL || plan->kernelImaginery == NULL){
+        return -1;
+    }
+
+    for(int n = 0; n < size; n++){
+        //n^2 modulo 2*size keeps the angle small and exact
+        long long square = (long long)n * n % (2LL * size);
+        double angle = -M_PI * square / size;
+        plan->chirp[n].real = cos(angle);
+        plan->chirp[n].imaginery = sin(angle);
+
+        plan->kernelReal[n] = plan->chirp[n].real;
+        plan->kernelImaginery[n] = -plan->chirp[n].imaginery;
+        if(n > 0){
+            plan->kernelReal[length - n] = plan->kernelReal[n];
+            plan->kernelImaginery[length - n] = plan->kernelImaginery[n];
+        }
+    }
+    fft_split(plan->convolution, plan->kernelReal, plan->kernelImaginery);
+    return 0;
+}
+
+const fftPlan_t *get_plan(int size){
+    for(fftPlan_t *plan = plans; plan != NULL; plan = plan->next){
+        if(plan->size == size){
+            return plan;
+        }
+    }
+
+    fftPlan_t *plan = calloc(1, sizeof(fftPlan_t));
+    if(plan == NULL){
+        return NULL;
+    }
+    plan->size = size;
+    plan->twiddles = malloc(sizeof(comNum_t) * (size / 2 > 0 ? size / 2 : 1));
+    if(plan->twiddles == NULL){
+        free_plan(plan);
+        return NULL;
+    }
+
+    for(int j = 0; j < size / 2; j++){
+        double angle = -2 * M_PI * j / size;
+        plan->twiddles[j].real = cos(angle);
+        plan->twiddles[j].imaginery = sin(angle);
+    }
+
+    if(is_power_of_two(size)){
+        //The level with half h starts at h-1, sum of all halves is size-1
+        int levelCount = size > 1 ? size - 1 : 1;
+        plan->real = malloc(sizeof(float) * levelCount);
+        plan->imaginery = malloc(sizeof(float) * levelCount);
+        if(plan->real == NULL || plan->imaginery == NULL){
+            free_plan(plan);
+            return NULL;
+        }
+        for(int half = 1; half < size; half *= 2){
+            int stride = size / (2 * half);
+            for(int i = 0; i < half; i++){
+                plan->real[half - 1 + i] = plan->twiddles[i * stride].real;
+                plan->imaginery[half - 1 + i] = plan->twiddles[i * stride].imaginery;
+            }
+        }
+    }
+    else if(factor(plan)){
+        plan->roots = malloc(sizeof(comNum_t) * size);
+        if(plan->roots == NULL){
+            free_plan(plan);
+            return NULL;
+        }
+        for(int j = 0; j < size; j++){
+            double angle = -2 * M_PI * j / size;
+            plan->roots[j].real = cos(angle);
+            plan->roots[j].imaginery = sin(angle);
+        }
+    }
+    else if(prepare_bluestein(plan) == -1){
+        free_plan(plan);
+        return NULL;
+    }
+
+    plan->next = plans;
+    plans = plan;
+    return plan;
+}
+
+const fftPlan_t *get_real_plan(int size){
+    int half = size / 2;
+    if(get_plan(half) == NULL){
+        return NULL;
+    }
+
+    //The plan of half is cached now, the table is added to it
+    fftPlan_t *plan = plans;
+    while(plan->size != half){
+        plan = plan->next;
+    }
+    if(plan->untangle != NULL){
+        return plan;
+    }
+
+    plan->untangle = malloc(sizeof(comNum_t) * (half / 2 + 1));
+    if(plan->untangle == NULL){
+        return NULL;
+    }
+    for(int k = 0; k <= half / 2; k++){
+        double angle = -2 * M_PI * k / size;
+        plan->untangle[k].real = cos(angle);
+        plan->untangle[k].imaginery = sin(angle);
+    }
+    return plan;
+}
+
+void free_plans(void){
+    while(plans != NULL){
+        fftPlan_t *next = plans->next;
+        free_plan(plans);
+        plans = next;
+    }
+}
+
+bool is_power_of_two(int size){
+    return size > 0 && (size & (size - 1)) == 0;
+}
+
+/**
+  * Bit reverse function
+  * @brief puts the input into bit-reversed index order
+  * @details After that the even and odd halves of every level lie next to each other.
+  * @param real real parts of the input
+  * @param imaginery imaginary parts of the input
+  * @param size size of the input, a power of two
+*/
+static void bit_reverse(float *real, float *imaginery, int size){
+    for(int i = 1, j = 0; i < size; i++){
+        int bit = size >> 1;
+        for(; j & bit; bit >>= 1){
+            j ^= bit;
+        }
+        j ^= bit;
+
+        if(i < j){
+            float tmp = real[i];
+            real[i] = real[j];
+            real[j] = tmp;
+            tmp = imaginery[i];
+            imaginery[i] = imaginery[j];
+            imaginery[j] = tmp;
+        }
+    }
+}
+
+/*
+ * Butterfly kernels over WIDTH indices at once, the same operations as
+ * butterfly() in forkFFT.c in the same order, so every width gives the same values.
+ * radix2 does one level with half h, radix4 the levels with half h and 2h in one pass.
+ */
+#define BUTTERFLY(er, ei, or, oi, wr, wi) do{ \
+    VEC pr_ = SUB(MUL(wr, or), MUL(wi, oi)); \
+    VEC pi_ = ADD(MUL(wr, oi), MUL(wi, or)); \
+    or = SUB(er, pr_); \
+    oi = SUB(ei, pi_); \
+    er = ADD(pr_, er); \
+    ei = ADD(pi_, ei); \
+} while(0)
+
+#define DEFINE_KERNELS(NAME, WIDTH, TARGET) \
+TARGET static void radix2_##NAME(float *re, float *im, const float *wre, const float *wim, int size, int half){ \
+    for(int start = 0; start < size; start += 2 * half){ \
+        float *r = re + start; \
+        float *m = im + start; \
+        for(int i = 0; i < half; i += WIDTH){ \
+            VEC wr = LOAD(wre + i), wi = LOAD(wim + i); \
+            VEC er = LOAD(r + i), ei = LOAD(m + i); \
+            VEC or = LOAD(r + i + half), oi = LOAD(m + i + half); \
+            BUTTERFLY(er, ei, or, oi, wr, wi); \
+            STORE(r + i, er); STORE(m + i, ei); \
+            STORE(r + i + half, or); STORE(m + i + half, oi); \
+        } \
+    } \
+} \
+TARGET static void radix4_##NAME(float *re, float *im, const float *w1re, const float *w1im, \
+    const float *w2re, const float *w2im, int size, int half){ \
+    for(int start = 0; start < size; start += 4 * half){ \
+        float *r = re + start; \
+        float *m = im + start; \
+        for(int i = 0; i < half; i += WIDTH){ \
+            VEC ar = LOAD(r + i), ai = LOAD(m + i); \
+            VEC br = LOAD(r + i + half), bi = LOAD(m + i + half); \
+            VEC cr = LOAD(r + i + 2*half), ci = LOAD(m + i + 2*half); \
+            VEC dr = LOAD(r + i + 3*half), di = LOAD(m + i + 3*half); \
+            VEC wr = LOAD(w1re + i), wi = LOAD(w1im + i); \
+            BUTTERFLY(ar, ai, br, bi, wr, wi); \
+            BUTTERFLY(cr, ci, dr, di, wr, wi); \
+            wr = LOAD(w2re + i); wi = LOAD(w2im + i); \
+            BUTTERFLY(ar, ai, cr, ci, wr, wi); \
+            wr = LOAD(w2re + i + half); wi = LOAD(w2im + i + half); \
+            BUTTERFLY(br, bi, dr, di, wr, wi); \
+            STORE(r + i, ar); STORE(m + i, ai); \
+            STORE(r + i + half, br); STORE(m + i + half, bi); \
+            STORE(r + i + 2*half, cr); STORE(m + i + 2*half, ci); \
+            STORE(r + i + 3*half, dr); STORE(m + i + 3*half, di); \
+        } \
+    } \
+}
+
+#define VEC float
+#define LOAD(p) (*(p))
+#define STORE(p, v) (*(p) = (v))
+#define ADD(a, b) ((a) + (b))
+#define SUB(a, b) ((a) - (b))
+#define MUL(a, b) ((a) * (b))
+DEFINE_KERNELS(scalar, 1, )
+#undef VEC
+#undef LOAD
+#undef STORE
+#undef ADD
+#undef SUB
+#undef MUL
+
+#ifdef HAVE_X86
+#define VEC __m128
+#define LOAD(p) _mm_loadu_ps(p)
+#define STORE(p, v) _mm_storeu_ps(p, v)
+#define ADD(a, b) _mm_add_ps(a, b)
+#define SUB(a, b) _mm_sub_ps(a, b)
+#define MUL(a, b) _mm_mul_ps(a, b)
+DEFINE_KERNELS(sse, 4, __attribute__((target("sse2"))))
+#undef VEC
+#undef LOAD
+#undef STORE
+#undef ADD
+#undef SUB
+#undef MUL
+
+#define VEC __m256
+#define LOAD(p) _mm256_loadu_ps(p)
+#define STORE(p, v) _mm256_storeu_ps(p, v)
+#define ADD(a, b) _mm256_add_ps(a, b)
+#define SUB(a, b) _mm256_sub_ps(a, b)
+#define MUL(a, b) _mm256_mul_ps(a, b)
+DEFINE_KERNELS(avx2, 8, __attribute__((target("avx2"))))
+#undef VEC
+#undef LOAD
+#undef STORE
+#undef ADD
+#undef SUB
+#undef MUL
+#endif
+
+/**
+  * Structure for kernels
+  * @brief The butterfly kernels of one instruction set
+  * @details Levels with a half smaller than width use the scalar kernels.
+*/
+struct Kernels{
+    int width;
+    void (*radix2)(float *, float *, const float *, const float *, int, int);
+    void (*radix4)(float *, float *, const float *, const float *, const float *, const float *, int, int);
+};
+
+static const struct Kernels scalarKernels = {1, radix2_scalar, radix4_scalar};
+#ifdef HAVE_X86
+static const struct Kernels sseKernels = {4, radix2_sse, radix4_sse};
+static const struct Kernels avx2Kernels = {8, radix2_avx2, radix4_avx2};
+#endif
+
+/**
+  * Select kernels function
+  * @brief the widest kernels the cpu supports
+*/
+static const struct Kernels *select_kernels(void){
+#ifdef HAVE_X86
+    if(__builtin_cpu_supports("avx2")){
+        return &avx2Kernels;
+    }
+    if(__builtin_cpu_supports("sse2")){
+        return &sseKernels;
+    }
+#endif
+    return &scalarKernels;
+}
+
+void fft_split(const fftPlan_t *plan, float *real, float *imaginery){
+    int size = plan->size;
+    const struct Kernels *kernels = select_kernels();
+    bit_reverse(real, imaginery, size);
+
+    for(int half = 1; half < size;){
+        const struct Kernels *use = half >= kernels->width ? kernels : &scalarKernels;
+        const float *wr = plan->real + half - 1;
+        const float *wi = plan->imaginery + half - 1;
+
+        if(4 * half <= size){
+            use->radix4(real, imaginery, wr, wi, plan->real + 2*half - 1, plan->imaginery + 2*half - 1, size, half);
+            half *= 4;
+        }
+        else{
+            use->radix2(real, imaginery, wr, wi, size, half);
+            half *= 2;
+        }
+    }
+}
+
+/**
+  * Multiply function
+  * @brief product of two complex numbers
+*/
+static inline comNum_t multiply(comNum_t a, comNum_t b){
+    comNum_t result = {a.real * b.real - a.imaginery * b.imaginery, a.real * b.imaginery + a.imaginery * b.real};
+    return result;
+}
+
+/**
+  * Mixed radix function
+  * @brief Cooley-Tukey transform for sizes made of the factors of the plan
+  * @details The first factor p splits the input into p interleaved parts which are
+  * transformed recursively and combined with a radix-p butterfly. Radix 2 and 4 are
+  * written out, 3, 5 and 7 use the direct transform of size p.
+  * @param in the input, every stride-th number
+  * @param stride distance of the numbers of in
+  * @param out to store the result, contiguous
+  * @param factors the remaining factors
+  * @param size product of the remaining factors
+  * @param roots e^(-2*pi*i*j/N) for j < N, N being the size of the plan
+  * @param rootStride N/size
+*/
+static void mixed_radix(const comNum_t *in, int stride, comNum_t *out, const int *factors, int size,
+    const comNum_t *roots, int rootStride){
+    int p = factors[0];
+    int m = size / p;
+
+    for(int q = 0; q < p; q++){
+        if(m == 1){
+            out[q] = in[q * stride];
+        }
+        else{
+            mixed_radix(in + q * stride, stride * p, out + q * m, factors + 1, m, roots, rootStride * p);
+        }
+    }
+
+    for(int k = 0; k < m; k++){
+        comNum_t t[7];
+        t[0] = out[k];
+        for(int q = 1; q < p; q++){
+            t[q] = multiply(out[q * m + k], roots[q * k * rootStride]);
+        }
+
+        if(p == 2){
+            out[k].real = t[0].real + t[1].real;
+            out[k].imaginery = t[0].imaginery + t[1].imaginery;
+            out[k + m].real = t[0].real - t[1].real;
+            out[k + m].imaginery = t[0].imaginery - t[1].imaginery;
+        }
+        else if(p == 4){
+            comNum_t a = {t[0].real + t[2].real, t[0].imaginery + t[2].imaginery};
+            comNum_t b = {t[0].real - t[2].real, t[0].imaginery - t[2].imaginery};
+            comNum_t c = {t[1].real + t[3].real, t[1].imaginery + t[3].imaginery};
+            comNum_t d = {t[1].real - t[3].real, t[1].imaginery - t[3].imaginery};
+            //multiplying by -i swaps the parts
+            out[k].real = a.real + c.real;
+            out[k].imaginery = a.imaginery + c.imaginery;
+            out[k + m].real = b.real + d.imaginery;
+            out[k + m].imaginery = b.imaginery - d.real;
+            out[k + 2*m].real = a.real - c.real;
+            out[k + 2*m].imaginery = a.imaginery - c.imaginery;
+            out[k + 3*m].real = b.real - d.imaginery;
+            out[k + 3*m].imaginery = b.imaginery + d.real;
+        }
+        else{
+            for(int r = 0; r < p; r++){
+                comNum_t sum = t[0];
+                for(int q = 1; q < p; q++){
+                    comNum_t product = multiply(t[q], roots[(q * r % p) * m * rootStride]);
+                    sum.real += product.real;
+                    sum.imaginery += product.imaginery;
+                }
+                out[k + r * m] = sum;
+            }
+        }
+    }
+}
+
+/**
+  * Bluestein function
+  * @brief transform of any size as a convolution of a power of two
+  * @details X[k] = w[k] * sum of x[n]*w[n] * conj(w[k-n]), the convolution is done
+  * with fft_split, the inverse as the transform of the conjugate.
+  * @param plan the plan
+  * @param data the input, overwritten with the result
+  * @return 0 on success, -1 if the memory couldn't be allocated
+*/
+static int bluestein(const fftPlan_t *plan, comNum_t *data){
+    int size = plan->size;
+    int length = plan->convolution->size;
+    float *real = calloc(2 * (size_t)length, sizeof(float));
+    if(real == NULL){
+        return -1;
+    }
+    float *imaginery = real + length;
+
+    for(int n = 0; n < size; n++){
+        comNum_t product = multiply(data[n], plan->chirp[n]);
+        real[n] = product.real;
+        imaginery[n] = product.imaginery;
+    }
+    fft_split(plan->convolution, real, imaginery);
+
+    for(int j = 0; j < length; j++){
+        float r = real[j] * plan->kernelReal[j] - imaginery[j] * plan->kernelImaginery[j];
+        float i = real[j] * plan->kernelImaginery[j] + imaginery[j] * plan->kernelReal[j];
+        real[j] = r;
+        imaginery[j] = -i;
+    }
+    fft_split(plan->convolution, real, imaginery);
+
+    for(int k = 0; k < size; k++){
+        comNum_t convolved = {real[k] / length, -imaginery[k] / length};
+        data[k] = multiply(convolved, plan->chirp[k]);
+    }
+    free(real);
+    return 0;
+}
+
+int fft(const fftPlan_t *plan, comNum_t *data){
+    int size = plan->size;
+
+    if(plan->roots != NULL){
+        comNum_t *input = malloc(sizeof(comNum_t) * size);
+        if(input == NULL){
+            return -1;
+        }
+        memcpy(input, data, sizeof(comNum_t) * size);
+        mixed_radix(input, 1, data, plan->factors, size, plan->roots, 1);
+        free(input);
+        return 0;
+    }
+    if(plan->convolution != NULL){
+        return bluestein(plan, data);
+    }
+
+    void *split;
+    if(posix_memalign(&split, 32, sizeof(float) * 2 * size) != 0){
+        return -1;
+    }
+    float *real = split;
+    float *imaginery = real + size;
+
+    for(int i = 0; i < size; i++){
+        real[i] = data[i].real;
+        imaginery[i] = data[i].imaginery;
+    }
+    fft_split(plan, real, imaginery);
+    for(int i = 0; i < size; i++){
+        data[i].real = real[i];
+        data[i].imaginery = imaginery[i];
+    }
+    free(split);
+    return 0;
+}
+
+void conjugate(comNum_t *data, int size, int divisor){
+    for(int i = 0; i < size; i++){
+        data[i].real = data[i].real / divisor;
+        //0 - x instead of -x, so a zero part doesn't become -0
+        data[i].imaginery = 0 - data[i].imaginery / divisor;
+    }
+}
+
+int ifft(const fftPlan_t *plan, comNum_t *data){
+    conjugate(data, plan->size, 1);
+    if(fft(plan, data) == -1){
+        return -1;
+    }
+    conjugate(data, plan->size, plan->size);
+    return 0;
+}
+
+bool is_real(const comNum_t *data, int size){
+    for(int i = 0; i < size; i++){
+        if(data[i].imaginery != 0){
+            return false;
+        }
+    }
+    return true;
+}
+
+int fft_real(const fftPlan_t *plan, comNum_t *data, bool full){
+    int half = plan->size;
+
+    //Going up, data[n] is written after data[2n] and data[2n+1] were read
+    for(int n = 0; n < half; n++){
+        comNum_t packed = {data[2*n].real, data[2*n + 1].real};
+        data[n] = packed;
+    }
+    if(fft(plan, data) == -1){
+        return -1;
+    }
+
+    //Z[k] = E[k] + i*O[k] with the transforms E and O of the even and odd samples
+    comNum_t first = data[0];
+    data[0].real = first.real + first.imaginery;
+    data[0].imaginery = 0;
+    data[half].real = first.real - first.imaginery;
+    data[half].imaginery = 0;
+
+    for(int k = 1; k <= half / 2; k++){
+        comNum_t z = data[k];
+        comNum_t mirror = data[half - k];
+        //E = (Z[k] + conj(Z[half-k]))/2, O = (Z[k] - conj(Z[half-k]))/(2i)
+        comNum_t even = {(z.real + mirror.real) / 2, (z.imaginery - mirror.imaginery) / 2};
+        comNum_t odd = {(z.imaginery + mirror.imaginery) / 2, (mirror.real - z.real) / 2};
+        comNum_t twisted = multiply(odd, plan->untangle[k]);
+
+        //X[k] = E + w^k*O, X[half-k] = conj(E - w^k*O)
+        data[k].real = even.real + twisted.real;
+        data[k].imaginery = even.imaginery + twisted.imaginery;
+        data[half - k].real = even.real - twisted.real;
+        data[half - k].imaginery = twisted.imaginery - even.imaginery;
+    }
+
+    if(full){
+        for(int k = 1; k < half; k++){
+            data[2*half - k].real = data[k].real;
+            data[2*half - k].imaginery = -data[k].imaginery;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,158 @@
+/**
+  * @file fft.h
+  * @author 
+  * @date 11.12.2022
+
+  * @brief Header file for the in-process FFT engine
+  * @details The transform runs in the calling process without forking.
+  * Powers of two use the iterative radix-2 Cooley-Tukey algorithm, sizes made
+  * of the factors 2, 3, 5 and 7 the recursive mixed-radix one and all other
+  * sizes Bluestein's algorithm on a power of two.
+*/
+#ifndef FFT_H
+#define FFT_H
+
+#include <stdbool.h>
+
+#include "forkFFT.h"
+
+
+//Most factors of a mixed-radix size, every factor is at least 2
+#define MAX_FACTORS 32
+
+/**
+  * Structure for FFT plans
+  * @brief The precomputed data for one transform size
+  * @details twiddles[j] is e^(-2*pi*i*j/size) for j < size/2. A level of length L
+  * uses every size/L-th entry, so one table serves all levels.
+  * real and imaginery hold the same values split per level, the twiddles of the
+  * level with half h start at index h-1, so the kernels load them contiguously.
+  * They are only set for powers of two. Mixed-radix sizes have their factors
+  * and all roots e^(-2*pi*i*j/size) instead, other sizes the chirp, the transformed
+  * kernel and the power of two plan of Bluestein's algorithm.
+  * untangle is only set for plans returned by get_real_plan, it holds
+  * e^(-2*pi*i*k/(2*size)) for k <= size/2.
+*/
+typedef struct FftPlan{
+    int size;
+    comNum_t *twiddles;
+    float *real;
+    float *imaginery;
+    int factors[MAX_FACTORS];
+    int factorCount;
+    comNum_t *roots;
+    comNum_t *chirp;
+    float *kernelReal;
+    float *kernelImaginery;
+    const struct FftPlan *convolution;
+    comNum_t *untangle;
+    struct FftPlan *next;
+} fftPlan_t;
+
+
+/**
+  * Get plan function
+  * @brief returns the plan for a transform size
+  * @details The plan is computed once per size in double precision and cached
+  * for all further transforms of that size. Computing a plan isn't thread-safe,
+  * threads may only get plans which were computed before they started.
+  * @param size size of the transform, at least 1
+  * @return the plan, NULL if the memory couldn't be allocated
+*/
+const fftPlan_t *get_plan(int size);
+
+/**
+  * Get real plan function
+  * @brief returns the plan for a transform size of real input
+  * @details That is the plan of half the size together with the twiddles which
+  * untangle its result. It is cached like get_plan.
+  * @param size size of the transform, even and at least 2
+  * @return the plan, NULL if the memory couldn't be allocated
+*/
+const fftPlan_t *get_real_plan(int size);
+
+/**
+  * Free plans function
+  * @brief frees all cached plans
+*/
+void free_plans(void);
+
+/**
+  * Is power of two function
+  * @brief checks if a size runs on the split radix-2 kernels
+  * @param size size of the input
+  * @return true if size is a power of two
+*/
+bool is_power_of_two(int size);
+
+/**
+  * FFT split function
+  * @brief Fast Fourier Transform in place on separate real and imaginary parts
+  * @details Only for powers of two. The input is put into bit-reversed order and then combined two levels
+  * at a time with the widest butterfly kernels the cpu supports (AVX2, SSE2 or
+  * scalar). They do the same operations as the butterfly of the process tree,
+  * so all of them give the same values.
+  * @param plan the plan for the size of the input
+  * @param real real parts of the input, overwritten with the result
+  * @param imaginery imaginary parts of the input, overwritten with the result
+*/
+void fft_split(const fftPlan_t *plan, float *real, float *imaginery);
+
+/**
+  * FFT function
+  * @brief Fast Fourier Transform in place
+  * @details For powers of two the input is split into real and imaginary parts
+  * once, transformed with fft_split and joined again. The values of the other
+  * sizes are close to, but not the same as, those of the process tree.
+  * @param plan the plan for the size of the input
+  * @param data the input, overwritten with the result
+  * @return 0 on success, -1 if the memory couldn't be allocated
+*/
+int fft(const fftPlan_t *plan, comNum_t *data);
+
+/**
+  * Conjugate function
+  * @brief conjugates numbers and divides them by a divisor
+  * @details The inverse transform is the conjugate of the transform of the
+  * conjugate, divided by the size.
+  * @param data the numbers, overwritten with the result
+  * @param size number of numbers
+  * @param divisor the divisor, 1 to only conjugate
+*/
+void conjugate(comNum_t *data, int size, int divisor);
+
+/**
+  * IFFT function
+  * @brief inverse Fast Fourier Transform in place
+  * @details x[n] = 1/size * sum of X[k]*e^(2*pi*i*k*n/size), computed with fft
+  * and the same plan as the forward transform.
+  * @param plan the plan for the size of the input
+  * @param data the input, overwritten with the result
+  * @return 0 on success, -1 if the memory couldn't be allocated
+*/
+int ifft(const fftPlan_t *plan, comNum_t *data);
+
+/**
+  * Is real function
+  * @brief checks if an input has no imaginary parts
+  * @param data the input
+  * @param size size of the input
+  * @return true if every imaginary part is 0
+*/
+bool is_real(const comNum_t *data, int size);
+
+/**
+  * FFT real function
+  * @brief Fast Fourier Transform of real input in place
+  * @details The real parts x[n] are packed into x[2n] + i*x[2n+1], which is
+  * transformed with half the size and untangled into X[k] for k <= size/2.
+  * The imaginary parts of the input are ignored. The other half of the
+  * spectrum is the conjugate, X[size-k] = conj(X[k]).
+  * @param plan the plan from get_real_plan
+  * @param data the input, overwritten with the result
+  * @param full fill in the other half too, otherwise only the first size/2+1 numbers are set
+  * @return 0 on success, -1 if the memory couldn't be allocated
+*/
+int fft_real(const fftPlan_t *plan, comNum_t *data, bool full);
+
+#endif
@@ -3,10 +3,30 @@
   * @author 
   * @date 11.12.2022
   * @brief Program for doing the Fast Fourir Transform
-  * @details Using Cooley-Tukey algorithm we can find FFT
+  * @details Using Cooley-Tukey algorithm we can find FFT.
+  * By default the transform runs in this process, with -f every recursion
+  * level forks two children which transform the even and odd halves in place
+  * in a shared mapping, so no data is copied between the processes.
+  * With -P the children are executed again with the internal -c flag and
+  * exchange binary frames with their parent through pipes instead.
+  * Both trees only fork down to a depth, the subtransforms below it
+  * run in-process. With -t the halves are tasks of a work-stealing thread
+  * pool instead, sharing the data in one address space.
+  * With -B the input is a sequence of frames which are transformed one by one.
+  * With -S the input is one long signal whose overlapping windows are transformed.
+  * -r prints only the first half of the spectrum of real input, in-process it
+  * is computed with a complex transform of half the size.
+  * -I computes the inverse transform instead. With -C or -X the input is
+  * convolved or correlated with the numbers of a file through padded transforms.
 */
 
 #include "forkFFT.h"
+#include "fft.h"
+#include "input.h"
+#include "output.h"
+#include "batch.h"
+#include "stft.h"
+#include "convolve.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -19,7 +39,17 @@
 #include <string.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/mman.h>
+#include <poll.h>
+#include <fcntl.h>
 #include <ctype.h>
+#include <limits.h>
+
+//Deepest process tree, 2^MAX_DEPTH leaves
+#define MAX_DEPTH 20
+
+//Largest subtransform the thread pool doesn't split
+#define THREAD_CUTOFF 4096
 
 char *progname = NULL;
 
@@ -30,7 +60,22 @@ char *progname = NULL;
   * exit on EXIT_FAILURE
 */
 void usage(void){
-    fprintf(stderr, "Usage: %s [-p] \n", progname);
+    fprintf(stderr, "Usage: %s [-p] [-r] [-I] [-f | -P] [-d DEPTH] [-t THREADS] [-B] [-S WINDOW [-H HOP] [-W FUNCTION]] [-C FILE | -X FILE] \n"
+        "-p rounds the output to 3 digits\n"
+        "-r prints only the results 0 to N/2 of real input, the others are their conjugates\n"
+        "   (in-process with half the work, the last digits may differ from -f, -P and -t)\n"
+        "-I computes the inverse transform\n"
+        "-f forks a process tree sharing the data instead of transforming in-process\n"
+        "-P forks a process tree passing the data through pipes\n"
+        "-d DEPTH levels of the tree which fork, 0 to %d (default log2 of the online cpus)\n"
+        "-t THREADS transforms with a pool of 1 to %d threads instead of processes\n"
+        "-B transforms every frame of the input, frames are separated by blank lines\n"
+        "-S WINDOW transforms every window of 2 to %d samples of the input\n"
+        "-H HOP samples between the starts of two windows (default WINDOW/2)\n"
+        "-W FUNCTION window function, hann or hamming (default hann)\n"
+        "-C FILE prints the linear convolution of the input with the numbers of FILE\n"
+        "-X FILE prints the cross-correlation of the input with the numbers of FILE\n",
+        progname, MAX_DEPTH, MAX_WORKERS, MAX_NUMBERS);
     exit(EXIT_FAILURE);
 }
 
@@ -42,7 +87,7 @@ void usage(void){
   * then the program error exists
   * @param msg containg the error message.
 */
-void error_exit(char *msg){
+void error_exit(const char *msg){
     fprintf(stderr, "Error occured: %s \n", msg);
     exit(EXIT_FAILURE);
 }
@@ -52,10 +97,13 @@ void error_exit(char *msg){
   * @brief use for spawning child processes
   * @details Pipes and the child process is generated
   * @param child the pid and pipes are stored in this sturcture
+  * @param depth levels the child may still fork
 */
 
-void spawn_children(child_t *child){
+void spawn_children(child_t *child, int depth){
     int pipes[2][2];
+    char depthAsString[16];
+    snprintf(depthAsString, sizeof(depthAsString), "%d", depth);
 
     if((pipe(pipes[0]) == -1) || (pipe(pipes[1]) == -1)){
         error_exit("Pipe creation failed!");
@@ -79,7 +127,7 @@ void spawn_children(child_t *child){
         close(pipes[0][0]);
         close(pipes[1][1]);
 
-        if(execlp(progname,progname, NULL) == -1){
+        if(execlp(progname,progname, "-P", "-c", "-d", depthAsString, NULL) == -1){
             error_exit("Excelp failedd");
         }
     }
@@ -89,6 +137,11 @@ void spawn_children(child_t *child){
 
     child->write = pipes[0][1];
     child->read = pipes[1][0];
+
+    //Later children mustn't hold the pipes of this one open
+    if(fcntl(child->write, F_SETFD, FD_CLOEXEC) == -1 || fcntl(child->read, F_SETFD, FD_CLOEXEC) == -1){
+        error_exit("fcntl failed");
+    }
     }  
    
     
@@ -96,28 +149,243 @@ void spawn_children(child_t *child){
 }
 
 /**
-  * Write to children function
-  * @brief writes to the children stdin
-  * @details The numbers at odd and even indices of input are written children responsible for odd and even.
-  * @param child_e child responsible for even index numbers
-  * @param child_o child responsible for odd index numbers
-  * @param evens array containing even index numbers
-  * @param odds array containing odd index numbers
-  * @param size size of both arrays
+  * Write all function
+  * @brief writes a whole buffer to a file descriptor
+  * @param fd the file descriptor
+  * @param data the buffer
+  * @param length length of the buffer
 */
-void write_to_childern(child_t *child_e, child_t *child_o, comNum_t *evens, comNum_t *odds, int size){
-    char oddAsString[MAXLENGTH];
-    char evenAsString[MAXLENGTH];
-   
-    for(int i = 0; i < size; i++){
-        snprintf(oddAsString, sizeof(oddAsString), "%f %f*i\n", odds[i].real, odds[i].imaginery);
-        snprintf(evenAsString, sizeof(evenAsString), "%f %f*i\n", evens[i].real, evens[i].imaginery);
+void write_all(int fd, const void *data, size_t length){
+    const char *pos = data;
+    while(length > 0){
+        ssize_t written = write(fd, pos, length);
+        if(written == -1){
+            if(errno == EINTR){
+                continue;
+            }
+            error_exit("Write failed");
+        }
+        pos += written;
+        length -= written;
+    }
+}
 
-        write(child_o->write, oddAsString, strlen(oddAsString));
-        write(child_e->write, evenAsString, strlen(evenAsString));
-    } 
-    
-  
+/**
+  * Read all function
+  * @brief reads a whole buffer from a file descriptor
+  * @param fd the file descriptor
+  * @param data the buffer
+  * @param length length of the buffer
+  * @return true if the buffer was filled, false on end of file
+*/
+bool read_all(int fd, void *data, size_t length){
+    char *pos = data;
+    while(length > 0){
+        ssize_t got = read(fd, pos, length);
+        if(got == -1){
+            if(errno == EINTR){
+                continue;
+            }
+            error_exit("Read failed");
+        }
+        if(got == 0){
+            return false;
+        }
+        pos += got;
+        length -= got;
+    }
+    return true;
+}
+
+/**
+  * Write frame function
+  * @brief writes complex numbers as a binary frame
+  * @param fd the file descriptor
+  * @param comNum the numbers
+  * @param size number of numbers
+*/
+void write_frame(int fd, const comNum_t *comNum, int size){
+    frameHeader_t header = {.count = size};
+    write_all(fd, &header, sizeof(header));
+    write_all(fd, comNum, sizeof(comNum_t) * size);
+}
+
+/**
+  * Read frame function
+  * @brief reads complex numbers from a binary frame
+  * @param fd the file descriptor
+  * @param size number of numbers read is stored here
+  * @return the numbers in a buffer of alloc_numbers
+*/
+comNum_t *read_frame(int fd, int *size){
+    frameHeader_t header;
+    if(!read_all(fd, &header, sizeof(header))){
+        error_exit("Missing frame");
+    }
+    if(header.count > MAX_NUMBERS){
+        error_exit("Frame too large");
+    }
+    comNum_t *comNum = alloc_numbers(header.count);
+    if(comNum == NULL){
+        error_exit("Malloc failed");
+    }
+    if(!read_all(fd, comNum, sizeof(comNum_t) * header.count)){
+        error_exit("Frame cut short");
+    }
+    *size = header.count;
+    return comNum;
+}
+
+/**
+  * Frame bytes function
+  * @brief finds the part of a frame at a byte offset
+  * @details A frame is its header followed by its numbers.
+  * @param header the header
+  * @param numbers the numbers
+  * @param offset bytes of the frame before the part
+  * @param length bytes of the part from offset on are stored here
+  * @return the part
+*/
+char *frame_bytes(frameHeader_t *header, comNum_t *numbers, size_t offset, size_t *length){
+    if(offset < sizeof(frameHeader_t)){
+        *length = sizeof(frameHeader_t) - offset;
+        return (char *)header + offset;
+    }
+    offset -= sizeof(frameHeader_t);
+    *length = sizeof(comNum_t) * header->count - offset;
+    return (char *)numbers + offset;
+}
+
+/**
+  * Reap child function
+  * @brief collects the exit status of a child
+  * @param transfer the transfer of the child
+  * @param options options of waitpid, WNOHANG to not wait
+*/
+void reap_child(transfer_t *transfer, int options){
+    int state;
+    pid_t pid = waitpid(transfer->child->pid, &state, options);
+    if(pid == 0){
+        return;
+    }
+    if(pid == -1 || !WIFEXITED(state) || WEXITSTATUS(state) != 0){
+        error_exit("WEXITSTATUS failed");
+    }
+    transfer->reaped = true;
+}
+
+/**
+  * Send part function
+  * @brief writes as much of the frame to a child as its pipe takes
+  * @details The pipe is closed once the whole frame is written.
+  * @param transfer the transfer of the child
+*/
+void send_part(transfer_t *transfer){
+    size_t length;
+    const char *part = frame_bytes(&transfer->header, transfer->numbers, transfer->sent, &length);
+    ssize_t written = write(transfer->child->write, part, length);
+    if(written == -1){
+        if(errno == EINTR || errno == EAGAIN){
+            return;
+        }
+        error_exit("Write failed");
+    }
+
+    transfer->sent += written;
+    if(transfer->sent == sizeof(frameHeader_t) + sizeof(comNum_t) * transfer->header.count){
+        close(transfer->child->write);
+        transfer->child->write = -1;
+    }
+}
+
+/**
+  * Receive part function
+  * @brief reads what a child has written of its frame
+  * @details The pipe is closed once the whole frame is read and the child
+  * is reaped if it already exited.
+  * @param transfer the transfer of the child
+*/
+void receive_part(transfer_t *transfer){
+    size_t length;
+    char *part = frame_bytes(&transfer->reply, transfer->numbers, transfer->received, &length);
+    ssize_t got = read(transfer->child->read, part, length);
+    if(got == -1){
+        if(errno == EINTR){
+            return;
+        }
+        error_exit("Read failed");
+    }
+    if(got == 0){
+        error_exit(transfer->received == 0 ? "Missing frame" : "Frame cut short");
+    }
+
+    transfer->received += got;
+    if(transfer->received == sizeof(frameHeader_t) && transfer->reply.count != transfer->header.count){
+        error_exit("Wrong frame size");
+    }
+    if(transfer->received == sizeof(frameHeader_t) + sizeof(comNum_t) * transfer->header.count){
+        close(transfer->child->read);
+        transfer->child->read = -1;
+        reap_child(transfer, WNOHANG);
+    }
+}
+
+/**
+  * Exchange frames function
+  * @brief sends two children their frames and receives theirs
+  * @details One poll loop serves the pipes of both children, so no child
+  * waits while the parent is blocked on the other one. The writes don't block,
+  * every pipe gets what it takes and the frames of the children are read as
+  * soon as they arrive. Children which are done are reaped right away, the
+  * others at the end.
+  * @param transfers the transfers of the children
+*/
+void exchange_frames(transfer_t transfers[2]){
+    for(int i = 0; i < 2; i++){
+        if(fcntl(transfers[i].child->write, F_SETFL, O_NONBLOCK) == -1){
+            error_exit("fcntl failed");
+        }
+    }
+
+    for(;;){
+        //A negative fd is skipped by poll
+        struct pollfd fds[2];
+        int polled = 0;
+        for(int i = 0; i < 2; i++){
+            child_t *child = transfers[i].child;
+            fds[i].fd = child->write != -1 ? child->write : child->read;
+            fds[i].events = child->write != -1 ? POLLOUT : POLLIN;
+            fds[i].revents = 0;
+            polled += fds[i].fd != -1;
+        }
+        if(polled == 0){
+            break;
+        }
+
+        if(poll(fds, 2, -1) == -1){
+            if(errno == EINTR){
+                continue;
+            }
+            error_exit("poll failed");
+        }
+        for(int i = 0; i < 2; i++){
+            if(fds[i].revents == 0){
+                continue;
+            }
+            if(fds[i].events == POLLOUT){
+                send_part(&transfers[i]);
+            }
+            else{
+                receive_part(&transfers[i]);
+            }
+        }
+    }
+
+    for(int i = 0; i < 2; i++){
+        if(!transfers[i].reaped){
+            reap_child(&transfers[i], 0);
+        }
+    }
 }
 
 /**
@@ -131,14 +399,11 @@ void write_to_childern(child_t *child_e, child_t *child_o, comNum_t *evens, comN
 void wait_for_children_to_finish(child_t *child_e, child_t *child_o){
     int state;
    
-    waitpid(child_e->pid, &state, 0);
-    
-    if(WEXITSTATUS(state) != 0){
+    if(waitpid(child_e->pid, &state, 0) == -1 || !WIFEXITED(state) || WEXITSTATUS(state) != 0){
         error_exit("WEXITSTATUS failed");
     }
 
-    waitpid(child_o->pid, &state, 0);
-    if(WEXITSTATUS(state) != 0){
+    if(waitpid(child_o->pid, &state, 0) == -1 || !WIFEXITED(state) || WEXITSTATUS(state) != 0){
         error_exit("WEXITSTATUS failed");
     }
 
@@ -193,24 +458,6 @@ void multiplication(comNum_t *c1, comNum_t *c2, comNum_t *result){
 }
 
 
-/**
-  * Read from file function
-  * @brief read the data from the children
-  * @param file file opened with fdopen of child
-  * @param comNum the values from the file is stored here
-*/
-void read_from_file(FILE *file, comNum_t *comNum){
-    char *line = NULL;
-    char *tmp_pointer;
-    size_t length = 0;
-
-    getline(&line, &length, file);
-    tmp_pointer = line;
-    comNum->real = strtof(line, &line);
-    comNum->imaginery = strtof(line, NULL);
-    free(tmp_pointer);
-}
-
 /**
   * Butterfly function
   * @brief Butterfly operation as described in pdf
@@ -218,22 +465,17 @@ void read_from_file(FILE *file, comNum_t *comNum){
   * @param o_result odd index results stored here
   * @param evens even index numbers from input
   * @param odds odd index nubmers from input
-  * @param size size of the input
-  * @param i index in evens and odds
+  * @param twiddle the twiddle factor of the index from the plan
 */
-void butterfly(comNum_t *e_result, comNum_t *o_result, comNum_t *evens, comNum_t *odds, int size, int i){
-    e_result->real = cos((-(2 * PI) / size) * i);
-  
-    e_result->imaginery = sin((-(2 * PI) / size) * i);
+void butterfly(comNum_t *e_result, comNum_t *o_result, comNum_t *evens, comNum_t *odds, const comNum_t *twiddle){
+    *e_result = *twiddle;
      
     multiplication(e_result,odds ,e_result);
      
     addition(e_result, evens, e_result);
     
   
-    o_result->real = cos((-(2 * PI) / size) * i);
-    
-    o_result->imaginery = sin((-(2 * PI) / size) * i);
+    *o_result = *twiddle;
  
     multiplication( o_result, odds,o_result);
  
@@ -244,24 +486,25 @@ void butterfly(comNum_t *e_result, comNum_t *o_result, comNum_t *evens, comNum_t
 /**
   * Calculate result
   * @brief calculates the result
-  * @param file_even even values to be read
-  * @param file_odd odd values to be read
+  * @param evens transformed even values of the children
+  * @param odds transformed odd values of the children
   * @param size size of the odd and even arrays
   * @param result to store results
 */
-void calculate_result(FILE *file_even, FILE *file_odd, int size, comNum_t *result){
-    int realSize = size*2;
-    for(int i = 0; i < size; i++){
-        comNum_t even;
-        comNum_t odd;
+void calculate_result(comNum_t *evens, comNum_t *odds, int size, comNum_t *result){
+    const fftPlan_t *plan = get_plan(size*2);
+    if(plan == NULL){
+        error_exit("Malloc failed");
+    }
 
-        read_from_file(file_even, &even);
-        read_from_file(file_odd, &odd);
+    for(int i = 0; i < size; i++){
+        comNum_t even = evens[i];
+        comNum_t odd = odds[i];
         
         comNum_t even_result;
         comNum_t odd_result;
 
-        butterfly(&even_result, &odd_result, &even, &odd, realSize, i);
+        butterfly(&even_result, &odd_result, &even, &odd, &plan->twiddles[i]);
 
         result[i] = even_result;
         result[i+size] = odd_result;
@@ -269,51 +512,6 @@ void calculate_result(FILE *file_even, FILE *file_odd, int size, comNum_t *resul
     }
 }
 
-/**
-  * Convert input to complex num function
-  * @brief converts the input to complex number
-  * @param comNum to store complex number
-  * @param index use for tracking the size of input
-*/
-void convert_input_to_complex_num(comNum_t *comNum, int *index){
-    char *endptr;
-
-    char *line = NULL;
-    size_t len = 0;
-    ssize_t nread;
-
-    while ((nread = getline(&line, &len, stdin)) != -1) {
-        comNum[(*index)].real = strtof(line, &endptr);
-       
-        if(comNum[(*index)].real == 0 && (line == endptr || errno != 0)){
-            error_exit("Wrong input (real)");
-        }
-
-        if(!(*endptr == ' ' || *endptr == '\n')){
-            error_exit("Wrong input (after)");
-        }
-
-        if(*endptr == ' '){
-            comNum[(*index)].imaginery = strtof(endptr, &endptr);
-            if(strcmp("*i\n", endptr) != 0){
-            error_exit("Wrong input (imaginary)");
-            }
-        if(*endptr == '\n'){
-            comNum[(*index)].imaginery = 0;
-        }
-    }
-    if(isspace(*endptr)){
-        comNum[(*index)].imaginery = 0;
-    }
-        
-
-        (*index)++;
-    }
-    free(line);
-
-}
-
-
 /**
   * Seperate odd even function
   * @brief Seperates the even and odd numbers from input
@@ -338,34 +536,263 @@ void seperate_odd_even(comNum_t *complexNumbers, comNum_t *odds, comNum_t *evens
 
 
 /**
-  * Print result
-  * @brief prints the result
-  * @details to tackle the -0.000 problem, fabs is used
+  * Default depth function
+  * @brief the depth of the process tree if -d is not given
+  * @details The tree has about one leaf per online cpu.
+  * @return log2 of the online cpus, rounded down
+*/
+int default_depth(void){
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int depth = 0;
+    while(depth < MAX_DEPTH && cpus >= (2L << depth)){
+        depth++;
+    }
+    return depth;
+}
+
+/**
+  * Transform in process function
+  * @brief does the FFT in this process
+  * @param data the input, overwritten with the result
+  * @param size size of the input
+*/
+void transform_in_process(comNum_t *data, int size){
+    if(size < 1){
+        error_exit("Wrong input size");
+    }
+
+    const fftPlan_t *plan = get_plan(size);
+    if(plan == NULL){
+        error_exit("Malloc failed");
+    }
+    if(fft(plan, data) == -1){
+        error_exit("Malloc failed");
+    }
+}
+
+/**
+  * Transform real function
+  * @brief Fast Fourier Transform of real input in this process
+  * @param data the input, overwritten with the result
+  * @param size size of the input, even
+  * @param full compute all results, otherwise only the first size/2+1
+*/
+void transform_real(comNum_t *data, int size, bool full){
+    const fftPlan_t *plan = get_real_plan(size);
+    if(plan == NULL || fft_real(plan, data, full) == -1){
+        error_exit("Malloc failed");
+    }
+}
+
+/**
+  * Print results function
+  * @brief prints the results
+  * @details They are formatted into one large buffer, see write_result.
   * @param p_flag to check if the input should be round 3 digits
-  * @param comNum result to be printed
+  * @param comNum results to be printed
+  * @param size number of results
 */
-void print_result(bool p_flag, comNum_t comNum){
-    if(p_flag){
-        
-        if (fabs(comNum.imaginery) < 0.0001 &&fabs(comNum.real) < 0.0001){
-            fprintf(stdout, "%.3f %.3f*i \n", fabs(comNum.real), fabs(comNum.imaginery));
+void print_results(bool p_flag, const comNum_t *comNum, int size){
+    static output_t output = {.fd = STDOUT_FILENO};
+
+    for(int i = 0; i < size; i++){
+        if(write_result(&output, p_flag, comNum[i]) == -1){
+            error_exit("Write failed");
         }
+    }
+    if(flush_output(&output) == -1){
+        error_exit("Write failed");
+    }
+}
 
-        else if(fabs(comNum.real) < 0.0001){
-            fprintf(stdout, "%.3f %.3f*i \n", fabs(comNum.real), comNum.imaginery);
+/**
+  * Fork FFT function
+  * @brief does the FFT with a process tree
+  * @details Two children transform the even and odd halves, their pipes
+  * are served together by exchange_frames. The results are combined with
+  * the butterfly operation.
+  * @param complexNumbers input
+  * @param size size of the input, even
+  * @param results to store results, may be the input
+  * @param depth levels which fork, at least 1
+*/
+void fork_fft(comNum_t *complexNumbers, int size, comNum_t *results, int depth){
+    int halfSize = size/2;
+    comNum_t *oddNums = alloc_numbers(halfSize);
+    comNum_t *evenNums = alloc_numbers(halfSize);
+    if(oddNums == NULL || evenNums == NULL){
+        error_exit("Malloc failed");
+    }
+    seperate_odd_even(complexNumbers, oddNums, evenNums, size);
+    
+    child_t child_e;
+    child_t child_o;
+
+    spawn_children(&child_e, depth - 1);
+    spawn_children(&child_o, depth - 1);
+
+    //The results of the children replace their halves
+    transfer_t transfers[2] = {
+        {.child = &child_e, .numbers = evenNums, .header = {.count = halfSize}},
+        {.child = &child_o, .numbers = oddNums, .header = {.count = halfSize}}
+    };
+    exchange_frames(transfers);
+
+    calculate_result(evenNums, oddNums, halfSize, results);
+    free(oddNums);
+    free(evenNums);
+}
+
+/**
+  * Shared FFT function
+  * @brief does the FFT in place with a process tree sharing the data
+  * @details The halves are separated into the first and second half of data,
+  * a forked child transforms each of them in place and the parent combines
+  * them in place once both have exited. Below depth the subrange is
+  * transformed in-process.
+  * @param data subrange of the shared mapping, overwritten with the result
+  * @param scratch subrange of the shared mapping of the same size
+  * @param size size of the subrange
+  * @param depth levels which fork
+*/
+void shared_fft(comNum_t *data, comNum_t *scratch, int size, int depth){
+    if(size == 1){
+        return;
+    }
+    //Odd sizes can't be halved
+    if(depth == 0 || size%2 != 0){
+        transform_in_process(data, size);
+        return;
+    }
+
+    int halfSize = size/2;
+    seperate_odd_even(data, scratch + halfSize, scratch, size);
+    memcpy(data, scratch, sizeof(comNum_t) * size);
+
+    child_t child_e = {.read = -1, .write = -1};
+    child_t child_o = {.read = -1, .write = -1};
+    child_t *children[2] = {&child_e, &child_o};
+
+    for(int i = 0; i < 2; i++){
+        children[i]->pid = fork();
+        if(children[i]->pid == -1){
+            error_exit("Forking failed!");
         }
-        else if (fabs(comNum.imaginery) < 0.0001){
-            fprintf(stdout, "%.3f %.3f*i \n", comNum.real, fabs(comNum.imaginery));
+        if(children[i]->pid == 0){
+            shared_fft(data + i*halfSize, scratch + i*halfSize, halfSize, depth - 1);
+            //The output stream belongs to the top process
+            _exit(EXIT_SUCCESS);
         }
-        else{
-            fprintf(stdout, "%.3f %.3f*i \n", comNum.real, comNum.imaginery);
+    }
+
+    wait_for_children_to_finish(&child_e, &child_o);
+
+    //Reads index i and i+halfSize before it writes them
+    calculate_result(data, data + halfSize, halfSize, data);
+}
+
+/**
+  * Complete thread task function
+  * @brief marks a task as done
+  * @details The last child of a task combines the halves and completes it,
+  * the root finishes the pool.
+  * @param pool the pool
+  * @param task the task
+*/
+void complete_thread_task(pool_t *pool, threadTask_t *task){
+    while(task->parent != NULL){
+        task = task->parent;
+        //The halves written by the other child are visible after the decrement
+        if(__atomic_sub_fetch(&task->pending, 1, __ATOMIC_ACQ_REL) != 0){
+            return;
         }
-        
+        int halfSize = task->size/2;
+        calculate_result(task->data, task->data + halfSize, halfSize, task->data);
     }
-    else{
-       
-        fprintf(stdout, "%f %f*i \n", comNum.real, comNum.imaginery);
+    finish_pool(pool);
+}
+
+/**
+  * Run thread task function
+  * @brief runs a task of the thread pool
+  * @param pool the pool
+  * @param worker the worker running the task
+  * @param task the task
+*/
+void run_thread_task(pool_t *pool, int worker, task_t *task){
+    threadTask_t *threadTask = (threadTask_t *)task;
+
+    if(threadTask->children[0] == NULL){
+        transform_in_process(threadTask->data, threadTask->size);
+        complete_thread_task(pool, threadTask);
+        return;
     }
+
+    int halfSize = threadTask->size/2;
+    seperate_odd_even(threadTask->data, threadTask->scratch + halfSize, threadTask->scratch, threadTask->size);
+    memcpy(threadTask->data, threadTask->scratch, sizeof(comNum_t) * threadTask->size);
+
+    threadTask->pending = 2;
+    push_task(pool, worker, &threadTask->children[1]->task);
+    push_task(pool, worker, &threadTask->children[0]->task);
+}
+
+/**
+  * Thread FFT function
+  * @brief does the FFT with a work-stealing thread pool
+  * @details The tasks form a complete binary tree stored like a heap,
+  * it is split until the leaves are at most THREAD_CUTOFF long or odd.
+  * @param data the input, overwritten with the result
+  * @param size size of the input
+  * @param threads number of threads
+*/
+void thread_fft(comNum_t *data, int size, int threads){
+    int levels = 0;
+    while((size >> levels) > THREAD_CUTOFF && (size >> levels) % 2 == 0){
+        levels++;
+    }
+    int count = (2 << levels) - 1;
+
+    //Threads only look plans up
+    for(int s = size; s >= (size >> levels) && s > 0; s /= 2){
+        if(get_plan(s) == NULL){
+            error_exit("Malloc failed");
+        }
+    }
+
+    comNum_t *scratch = malloc(sizeof(comNum_t) * size);
+    threadTask_t *tasks = calloc(count, sizeof(threadTask_t));
+    pool_t pool;
+    if(scratch == NULL || tasks == NULL || create_pool(&pool, threads, count) == -1){
+        error_exit("Malloc failed");
+    }
+
+    tasks[0].data = data;
+    tasks[0].scratch = scratch;
+    tasks[0].size = size;
+    for(int i = 0; i < count; i++){
+        tasks[i].task.run = run_thread_task;
+        if(2*i + 1 >= count){
+            continue;
+        }
+        int halfSize = tasks[i].size/2;
+        for(int k = 0; k < 2; k++){
+            threadTask_t *child = &tasks[2*i + 1 + k];
+            child->data = tasks[i].data + k*halfSize;
+            child->scratch = tasks[i].scratch + k*halfSize;
+            child->size = halfSize;
+            child->parent = &tasks[i];
+            tasks[i].children[k] = child;
+        }
+    }
+
+    if(run_pool(&pool, &tasks[0].task) == -1){
+        error_exit("Malloc failed");
+    }
+
+    free_pool(&pool);
+    free(tasks);
+    free(scratch);
 }
 
 /**
@@ -381,10 +808,23 @@ int main(int argc, char **argv){
 
 
     bool p_flag = false;
+    bool f_flag = false;
+    bool P_flag = false;
+    bool c_flag = false;
+    bool B_flag = false;
+    bool r_flag = false;
+    bool I_flag = false;
+    const char *kernelPath = NULL;
+    bool correlate = false;
+    int depth = -1;
+    int threads = 0;
+    int window = 0;
+    int hop = 0;
+    int function = -1;
 
     int c = 0;
 
-    while((c = getopt(argc, argv, "p")) != -1){
+    while((c = getopt(argc, argv, "prIfPcd:t:BS:H:W:C:X:")) != -1){
         switch (c){
             case 'p':
                 if(p_flag == true){
@@ -393,6 +833,113 @@ int main(int argc, char **argv){
                 }
                 p_flag = true;
                 break;
+            case 'r':
+                if(r_flag == true){
+                    usage();
+                    break;
+                }
+                r_flag = true;
+                break;
+            case 'I':
+                if(I_flag == true){
+                    usage();
+                    break;
+                }
+                I_flag = true;
+                break;
+            case 'C':
+            case 'X':
+                if(kernelPath != NULL){
+                    usage();
+                    break;
+                }
+                kernelPath = optarg;
+                correlate = c == 'X';
+                break;
+            case 'f':
+                if(f_flag == true){
+                    usage();
+                    break;
+                }
+                f_flag = true;
+                break;
+            case 'P':
+                if(P_flag == true){
+                    usage();
+                    break;
+                }
+                P_flag = true;
+                break;
+            case 'd':{
+                if(depth != -1){
+                    usage();
+                    break;
+                }
+                char *endptr;
+                errno = 0;
+                long value = strtol(optarg, &endptr, 10);
+                if(errno != 0 || endptr == optarg || *endptr != '\0' || value < 0 || value > MAX_DEPTH){
+                    usage();
+                }
+                depth = (int)value;
+                break;
+            }
+            case 't':{
+                if(threads != 0){
+                    usage();
+                    break;
+                }
+                char *endptr;
+                errno = 0;
+                long value = strtol(optarg, &endptr, 10);
+                if(errno != 0 || endptr == optarg || *endptr != '\0' || value < 1 || value > MAX_WORKERS){
+                    usage();
+                }
+                threads = (int)value;
+                break;
+            }
+            case 'B':
+                if(B_flag == true){
+                    usage();
+                    break;
+                }
+                B_flag = true;
+                break;
+            case 'S':
+            case 'H':{
+                int *target = c == 'S' ? &window : &hop;
+                if(*target != 0){
+                    usage();
+                    break;
+                }
+                char *endptr;
+                errno = 0;
+                long value = strtol(optarg, &endptr, 10);
+                if(errno != 0 || endptr == optarg || *endptr != '\0' || value < (c == 'S' ? 2 : 1) || value > MAX_NUMBERS){
+                    usage();
+                }
+                *target = (int)value;
+                break;
+            }
+            case 'W':
+                if(function != -1){
+                    usage();
+                    break;
+                }
+                if(strcmp(optarg, "hann") == 0){
+                    function = WINDOW_HANN;
+                }
+                else if(strcmp(optarg, "hamming") == 0){
+                    function = WINDOW_HAMMING;
+                }
+                else{
+                    usage();
+                }
+                break;
+            case 'c':
+                //internal, the parent reads the result
+                c_flag = true;
+                break;
             case '?':
                 usage();
                 break;
@@ -403,61 +950,137 @@ int main(int argc, char **argv){
     }
 
     //Checking the input size
-    if((p_flag && argc != 2) || (!p_flag && argc != 1)){
+    if(optind != argc || (f_flag && P_flag) || (c_flag && (p_flag || !P_flag))
+        || (depth != -1 && !f_flag && !P_flag) || (threads != 0 && (f_flag || P_flag))
+        || (B_flag && (f_flag || P_flag || threads != 0))
+        || ((hop != 0 || function != -1) && window == 0)
+        || (window != 0 && (f_flag || P_flag || threads != 0 || B_flag))
+        || (r_flag && (c_flag || B_flag || window != 0))
+        || (I_flag && (c_flag || B_flag || window != 0))
+        || (kernelPath != NULL && (f_flag || P_flag || threads != 0 || B_flag || window != 0 || r_flag || I_flag))){
         usage();
     }
 
-    comNum_t complexNumbers[MAXLENGTH];
-    int size = 0;
-
-    convert_input_to_complex_num(complexNumbers, &size);
-
+    if(kernelPath != NULL){
+        const char *error = run_convolution(kernelPath, correlate, p_flag);
+        if(error != NULL){
+            error_exit(error);
+        }
+        exit(EXIT_SUCCESS);
+    }
 
-    if(size == 1){
-        print_result(p_flag, complexNumbers[0]);
+    if(window != 0){
+        const char *error = run_stft(window, hop != 0 ? hop : window / 2,
+            function != -1 ? (windowFunction_t)function : WINDOW_HANN, p_flag);
+        if(error != NULL){
+            error_exit(error);
+        }
         exit(EXIT_SUCCESS);
     }
 
-   
-    if(size%2 != 0){
-        error_exit("Wrong input size");
+    if(B_flag){
+        const char *error = run_batch(p_flag);
+        if(error != NULL){
+            error_exit(error);
+        }
+        exit(EXIT_SUCCESS);
+    }
+    if(depth == -1){
+        depth = default_depth();
     }
 
+    comNum_t *complexNumbers;
+    int size = 0;
 
-    int halfSize = size/2;
-    comNum_t oddNums[halfSize];
-    comNum_t evenNums[halfSize];
-    seperate_odd_even(complexNumbers, oddNums, evenNums, size);
-    
-    child_t child_e;
-    child_t child_o;
+    if(c_flag){
+        complexNumbers = read_frame(STDIN_FILENO, &size);
+    }
+    else{
+        inputError_t error = read_input(STDIN_FILENO, &complexNumbers, &size);
+        if(error != INPUT_OK){
+            error_exit(input_error_message(error));
+        }
+    }
 
-    spawn_children(&child_e);
-    spawn_children(&child_o);
 
+    //Every mode rejects empty input the same way
+    if(size == 0){
+        error_exit("Wrong input size");
+    }
+    if(r_flag && !is_real(complexNumbers, size)){
+        error_exit("Input isn't real");
+    }
+    //The number of results printed
+    int printed = r_flag ? size / 2 + 1 : size;
 
-    write_to_childern(&child_e, &child_o, evenNums, oddNums, halfSize);
-    
+    if(size == 1){
+        if(c_flag){
+            write_frame(STDOUT_FILENO, complexNumbers, size);
+        }
+        else{
+            print_results(p_flag, complexNumbers, size);
+        }
+        exit(EXIT_SUCCESS);
+    }
+
+    //The inverse is the conjugate of the transform of the conjugate
+    if(I_flag){
+        conjugate(complexNumbers, size, 1);
+    }
    
+    if(f_flag){
 
-    close(child_o.write);
-    close(child_e.write);
-    
-    wait_for_children_to_finish(&child_e, &child_o);
+        //Twice the input, the second half is the scratch of separate_odd_even
+        size_t length = sizeof(comNum_t) * size * 2;
+        comNum_t *shared = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if(shared == MAP_FAILED){
+            error_exit("mmap failed");
+        }
+        memcpy(shared, complexNumbers, sizeof(comNum_t) * size);
 
-   
-    FILE *f_e = fdopen(child_e.read, "r");
-    FILE *f_o = fdopen(child_o.read, "r");
+        shared_fft(shared, shared + size, size, depth);
+
+        if(I_flag){
+            conjugate(shared, printed, size);
+        }
+        print_results(p_flag, shared, printed);
+        munmap(shared, length);
+        exit(EXIT_SUCCESS);
+    }
 
+    if(P_flag){
 
-    comNum_t results[size];
-    calculate_result(f_e, f_o, halfSize, results);
+        if(depth == 0 || size%2 != 0){
+            transform_in_process(complexNumbers, size);
+        }
+        else{
+            fork_fft(complexNumbers, size, complexNumbers, depth);
+        }
 
-    for(int i = 0; i < size; i++){
-        print_result(p_flag, results[i]);
+        if(c_flag){
+            write_frame(STDOUT_FILENO, complexNumbers, size);
+            exit(EXIT_SUCCESS);
+        }
+        if(I_flag){
+            conjugate(complexNumbers, printed, size);
+        }
+        print_results(p_flag, complexNumbers, printed);
+        exit(EXIT_SUCCESS);
     }
 
-    fclose(f_o);
-    fclose(f_e);
+    if(threads != 0){
+        thread_fft(complexNumbers, size, threads);
+    }
+    else if(r_flag && size % 2 == 0){
+        transform_real(complexNumbers, size, false);
+    }
+    else{
+        transform_in_process(complexNumbers, size);
+    }
+
+    if(I_flag){
+        conjugate(complexNumbers, printed, size);
+    }
+    print_results(p_flag, complexNumbers, printed);
     exit(EXIT_SUCCESS);
 }
\ No newline at end of file
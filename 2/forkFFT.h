@@ -5,11 +5,18 @@
 
   * @brief Header file for FORKFTT
 */
+#ifndef FORKFFT_H
+#define FORKFFT_H
+
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pool.h"
 
 
-#define PI 3.141592654
-#define MAXLENGTH 100000
+//Most complex numbers of an input
+#define MAX_NUMBERS (1 << 28)
 
 
 /**
@@ -23,13 +30,63 @@ typedef struct ComplexNumber{
 } comNum_t;
 
 
+/**
+  * Structure for frame headers
+  * @brief The header of the binary data between parent and child
+  * @details It is followed by count complex numbers as packed float pairs.
+*/
+typedef struct FrameHeader{
+    uint32_t count;
+} frameHeader_t;
+
+
+/**
+  * Structure for thread tasks
+  * @brief A subtransform of the thread pool
+  * @details A task with children separates its range into the halves of the
+  * children. The last child to finish combines them, pending counts the
+  * children which are not done yet. Tasks without children are transformed
+  * in-process.
+*/
+typedef struct ThreadTask{
+    task_t task;
+    comNum_t *data;
+    comNum_t *scratch;
+    int size;
+    int pending;
+    struct ThreadTask *parent;
+    struct ThreadTask *children[2];
+} threadTask_t;
+
+
 /**
   * Structure for child process
   * @brief The representation of a child process.
   * @details pid for process id, write to write to child's stdin and read to read from child's stdout
+  * The pipes are -1 for children sharing the data.
 */
 typedef struct Child{
     pid_t pid;
     int write;
     int read;
 } child_t;
+
+
+/**
+  * Structure for frame transfers
+  * @brief The frames exchanged with a child through its pipes
+  * @details The frame to the child is sent from numbers and the frame of the
+  * child is received into numbers, which is only read once the sent frame was
+  * written completely. sent and received count the bytes of header and numbers.
+*/
+typedef struct Transfer{
+    child_t *child;
+    comNum_t *numbers;
+    frameHeader_t header;
+    frameHeader_t reply;
+    size_t sent;
+    size_t received;
+    bool reaped;
+} transfer_t;
+
+#endif
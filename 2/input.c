@@ -0,0 +1,433 @@
+/**
+  * @file input.c
+  * @author
+  * @date 11.12.2022
+  * @brief Implementation of input.h
+*/
+
+#include "input.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <unistd.h>
+
+//Most decimal digits of the fast path, 10^19 < 2^64
+#define MAX_DIGITS 19
+
+//Powers of ten which are exact doubles
+static const double powers[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+#define MAX_POWER 22
+
+
+comNum_t *alloc_numbers(size_t count){
+    void *numbers;
+    if(posix_memalign(&numbers, NUMBER_ALIGNMENT, sizeof(comNum_t) * (count > 0 ? count : 1)) != 0){
+        return NULL;
+    }
+    return numbers;
+}
+
+/**
+  * Is digit function
+  * @brief checks for a decimal digit without the locale
+*/
+static inline bool is_digit(char c){
+    return c >= '0' && c <= '9';
+}
+
+/**
+  * Parse fast function
+  * @brief parses a plain decimal number
+  * @details Handles [sign]digits[.digits][e[sign]digits] followed by ' ', '\n' or '*'.
+  * The value is rounded like strtof: with at most 2^53 as the digits and a power of
+  * ten of at most 22 one double operation is exact up to its last bit, which only
+  * rounds to another float than strtof if it hits the middle of two floats.
+  * @param start first character of the number
+  * @param value the number is stored here
+  * @param end the first character after the number is stored here
+  * @return false if the number has to be parsed by strtof
+*/
+static bool parse_fast(const char *start, float *value, const char **end){
+    const char *p = start;
+    bool negative = false;
+    if(*p == '+' || *p == '-'){
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+
+    //Leading zeros don't count as digits
+    while(*p == '0'){
+        any = true;
+        p++;
+    }
+    for(; is_digit(*p); p++){
+        if(digits == MAX_DIGITS){
+            return false;
+        }
+        mantissa = mantissa * 10 + (*p - '0');
+        digits++;
+        any = true;
+    }
+    if(*p == '.'){
+        p++;
+        for(; is_digit(*p); p++){
+            any = true;
+            if(mantissa == 0 && *p == '0'){
+                exponent--;
+                continue;
+            }
+            if(digits == MAX_DIGITS){
+                return false;
+            }
+            mantissa = mantissa * 10 + (*p - '0');
+            digits++;
+            exponent--;
+        }
+    }
+    if(!any){
+        return false;
+    }
+
+    if(*p == 'e' || *p == 'E'){
+        p++;
+        int sign = 1;
+        if(*p == '+' || *p == '-'){
+            sign = *p == '-' ? -1 : 1;
+            p++;
+        }
+        if(!is_digit(*p)){
+            return false;
+        }
+        int written = 0;
+        for(; is_digit(*p); p++){
+            if(written < 10000){
+                written = written * 10 + (*p - '0');
+            }
+        }
+        exponent += sign * written;
+    }
+
+    if(*p != ' ' && *p != '\n' && *p != '*'){
+        return false;
+    }
+
+    if(mantissa == 0){
+        *value = negative ? -0.0f : 0.0f;
+        *end = p;
+        return true;
+    }
+    if(mantissa > (UINT64_C(1) << 53) || exponent < -MAX_POWER || exponent > MAX_POWER){
+        return false;
+    }
+
+    double exact = exponent < 0 ? (double)mantissa / powers[-exponent] : (double)mantissa * powers[exponent];
+    float rounded = (float)exact;
+    if((double)rounded != exact){
+        float next = nextafterf(rounded, exact > rounded ? HUGE_VALF : -HUGE_VALF);
+        if(exact == ((double)rounded + next) / 2){
+            return false;
+        }
+    }
+
+    *value = negative ? -rounded : rounded;
+    *end = p;
+    return true;
+}
+
+/**
+  * Parse number function
+  * @brief parses a number like strtof without leaving the line
+  * @param start where the number starts, blanks are skipped
+  * @param value the number is stored here
+  * @param range set if the number was out of range
+  * @return the first character after the number, start if there is none
+*/
+static const char *parse_number(const char *start, float *value, bool *range){
+    const char *p = start;
+    while(*p == ' ' || *p == '\t' || *p == '\v' || *p == '\f' || *p == '\r'){
+        p++;
+    }
+
+    *value = 0;
+    *range = false;
+    //strtof would skip the newline and read the next line
+    if(*p == '\n' || *p == '\0'){
+        return start;
+    }
+
+    const char *end;
+    if(parse_fast(p, value, &end)){
+        return end;
+    }
+
+    char *strtofEnd;
+    errno = 0;
+    *value = strtof(p, &strtofEnd);
+    *range = errno == ERANGE;
+    return strtofEnd == p ? start : strtofEnd;
+}
+
+/**
+  * Parse line function
+  * @brief parses one line of the input
+  * @param line the line, ending with '\n' or the end of the input
+  * @param number the number is stored here
+  * @param next the start of the next line is stored here
+  * @return INPUT_OK or the error
+*/
+static inputError_t parse_line(const char *line, comNum_t *number, const char **next){
+    bool range;
+    const char *end = parse_number(line, &number->real, &range);
+    if(number->real == 0 && (end == line || range)){
+        return INPUT_REAL;
+    }
+
+    if(*end == '\n'){
+        number->imaginery = 0;
+        *next = end + 1;
+        return INPUT_OK;
+    }
+    if(*end != ' '){
+        return INPUT_AFTER;
+    }
+
+    const char *imaginaryEnd = parse_number(end, &number->imaginery, &range);
+    if(imaginaryEnd == end || strncmp(imaginaryEnd, "*i\n", 3) != 0){
+        return INPUT_IMAGINARY;
+    }
+    *next = imaginaryEnd + 3;
+    return INPUT_OK;
+}
+
+/**
+  * Grow numbers function
+  * @brief makes room for one more number
+  * @param numbers the buffer, replaced by a bigger one if it is full
+  * @param size numbers in the buffer
+  * @param capacity space of the buffer
+  * @return INPUT_OK or the error
+*/
+static inputError_t grow_numbers(comNum_t **numbers, int size, int *capacity){
+    if(size < *capacity){
+        return INPUT_OK;
+    }
+    if(*capacity >= MAX_NUMBERS){
+        return INPUT_TOO_LONG;
+    }
+
+    int grown = *capacity > MAX_NUMBERS / 2 ? MAX_NUMBERS : *capacity * 2;
+    comNum_t *bigger = alloc_numbers(grown);
+    if(bigger == NULL){
+        return INPUT_MEMORY;
+    }
+    memcpy(bigger, *numbers, sizeof(comNum_t) * size);
+    free(*numbers);
+    *numbers = bigger;
+    *capacity = grown;
+    return INPUT_OK;
+}
+
+/**
+  * Fill input function
+  * @brief reads the next block
+  * @details The unparsed text is moved to the front first, the buffer
+  * grows if a single line doesn't fit.
+  * @param input the input
+  * @return INPUT_OK or the error
+*/
+static inputError_t fill_input(input_t *input){
+    memmove(input->text, input->text + input->start, input->length - input->start);
+    input->length -= input->start;
+    input->start = 0;
+
+    if(input->length == input->capacity){
+        char *bigger = realloc(input->text, input->capacity * 2 + 1);
+        if(bigger == NULL){
+            return INPUT_MEMORY;
+        }
+        input->text = bigger;
+        input->capacity *= 2;
+    }
+
+    for(;;){
+        ssize_t got = read(input->fd, input->text + input->length, input->capacity - input->length);
+        if(got == -1){
+            if(errno == EINTR){
+                continue;
+            }
+            return INPUT_READ;
+        }
+        if(got == 0){
+            //A last line without '\n' is parsed to get its error
+            input->text[input->length] = '\0';
+            input->ended = true;
+        }
+        input->length += got;
+        return INPUT_OK;
+    }
+}
+
+/**
+  * Read lines function
+  * @brief parses lines until the end of the input or of a frame
+  * @param input the input
+  * @param numbers the buffer, grown if needed
+  * @param size numbers in the buffer
+  * @param capacity space of the buffer
+  * @param batch a blank line ends a frame, the numbers before it are returned
+  * @param limit most numbers in the buffer, the lines after them are left, 0 for no limit
+  * @return INPUT_OK or the error
+*/
+static inputError_t read_lines(input_t *input, comNum_t **numbers, int *size, int *capacity, bool batch, int limit){
+    for(;;){
+        //Only lines which are complete or the last one are parsed
+        size_t complete = input->length;
+        if(!input->ended){
+            while(complete > input->start && input->text[complete - 1] != '\n'){
+                complete--;
+            }
+        }
+
+        const char *line = input->text + input->start;
+        const char *end = input->text + complete;
+        while(line < end){
+            if(limit > 0 && *size == limit){
+                input->start = line - input->text;
+                return INPUT_OK;
+            }
+            if(batch && *line == '\n'){
+                line++;
+                //Blank lines after each other are one separator
+                if(*size > 0){
+                    input->start = line - input->text;
+                    return INPUT_OK;
+                }
+                continue;
+            }
+
+            inputError_t error = grow_numbers(numbers, *size, capacity);
+            if(error == INPUT_OK){
+                error = parse_line(line, &(*numbers)[*size], &line);
+            }
+            if(error != INPUT_OK){
+                return error;
+            }
+            (*size)++;
+        }
+        input->start = complete;
+
+        if(input->ended){
+            return INPUT_OK;
+        }
+        inputError_t error = fill_input(input);
+        if(error != INPUT_OK){
+            return error;
+        }
+    }
+}
+
+int open_input(input_t *input, int fd){
+    input->fd = fd;
+    input->start = 0;
+    input->length = 0;
+    input->capacity = INPUT_BLOCK;
+    input->ended = false;
+    //One more for the '\0' after the last line
+    input->text = malloc(input->capacity + 1);
+    return input->text == NULL ? -1 : 0;
+}
+
+void close_input(input_t *input){
+    free(input->text);
+    input->text = NULL;
+}
+
+/**
+  * Read numbers function
+  * @brief reads numbers into a new buffer
+  * @param input the input
+  * @param numbers the buffer is stored here
+  * @param size number of numbers is stored here
+  * @param batch stop at a blank line
+  * @return INPUT_OK or the error
+*/
+static inputError_t read_numbers(input_t *input, comNum_t **numbers, int *size, bool batch){
+    int capacity = 1024;
+    *size = 0;
+    *numbers = alloc_numbers(capacity);
+    if(*numbers == NULL){
+        return INPUT_MEMORY;
+    }
+
+    inputError_t error = read_lines(input, numbers, size, &capacity, batch, 0);
+    if(error != INPUT_OK){
+        free(*numbers);
+        *numbers = NULL;
+        *size = 0;
+    }
+    return error;
+}
+
+inputError_t read_input(int fd, comNum_t **numbers, int *size){
+    input_t input;
+    if(open_input(&input, fd) == -1){
+        return INPUT_MEMORY;
+    }
+    inputError_t error = read_numbers(&input, numbers, size, false);
+    close_input(&input);
+    return error;
+}
+
+inputError_t read_batch(input_t *input, comNum_t **numbers, int *size){
+    inputError_t error = read_numbers(input, numbers, size, true);
+    if(error == INPUT_OK && *size == 0){
+        free(*numbers);
+        *numbers = NULL;
+        return INPUT_END;
+    }
+    return error;
+}
+
+inputError_t read_samples(input_t *input, comNum_t *numbers, int count, int *got){
+    int capacity = count;
+    *got = 0;
+    return read_lines(input, &numbers, got, &capacity, false, count);
+}
+
+bool input_pending(const input_t *input){
+    return input->start < input->length;
+}
+
+const char *input_error_message(inputError_t error){
+    switch(error){
+        case INPUT_OK:
+            return "No error";
+        case INPUT_END:
+            return "End of input";
+        case INPUT_MEMORY:
+            return "Malloc failed";
+        case INPUT_READ:
+            return "Read failed";
+        case INPUT_TOO_LONG:
+            return "Input too long";
+        case INPUT_REAL:
+            return "Wrong input (real)";
+        case INPUT_AFTER:
+            return "Wrong input (after)";
+        case INPUT_IMAGINARY:
+            return "Wrong input (imaginary)";
+    }
+    return "Wrong input";
+}
@@ -0,0 +1,134 @@
+/**
+  * @file input.h
+  * @author
+  * @date 11.12.2022
+
+  * @brief Header file for reading the input of forkFFT
+  * @details Every line is "REAL\n" or "REAL IMAGINARY*i\n". The input is read
+  * in large blocks and the numbers are parsed by hand, only numbers the fast
+  * path can't round exactly like strtof are given to strtof.
+*/
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdbool.h>
+
+#include "forkFFT.h"
+
+
+//Bytes read at once
+#define INPUT_BLOCK (1 << 20)
+
+//Alignment of the number buffers
+#define NUMBER_ALIGNMENT 64
+
+
+/**
+  * Input errors
+  * @brief Why the input couldn't be read
+*/
+typedef enum InputError{
+    INPUT_OK = 0,
+    INPUT_END,
+    INPUT_MEMORY,
+    INPUT_READ,
+    INPUT_TOO_LONG,
+    INPUT_REAL,
+    INPUT_AFTER,
+    INPUT_IMAGINARY
+} inputError_t;
+
+
+/**
+  * Structure for inputs
+  * @brief The text of a file descriptor which wasn't parsed yet
+  * @details text[start] up to text[length] is read but not parsed,
+  * ended is set once the end of the file was read.
+*/
+typedef struct Input{
+    int fd;
+    char *text;
+    size_t start;
+    size_t length;
+    size_t capacity;
+    bool ended;
+} input_t;
+
+
+/**
+  * Alloc numbers function
+  * @brief allocates an aligned buffer of complex numbers
+  * @param count number of complex numbers
+  * @return the buffer, NULL if the memory couldn't be allocated
+*/
+comNum_t *alloc_numbers(size_t count);
+
+/**
+  * Read input function
+  * @brief reads all complex numbers from a file descriptor
+  * @details The numbers are stored in an aligned heap buffer which grows
+  * as needed, up to MAX_NUMBERS numbers.
+  * @param fd the file descriptor
+  * @param numbers the buffer is stored here, free it with free
+  * @param size number of numbers is stored here
+  * @return INPUT_OK or the error
+*/
+inputError_t read_input(int fd, comNum_t **numbers, int *size);
+
+/**
+  * Open input function
+  * @brief sets up reading frames from a file descriptor
+  * @param input the input
+  * @param fd the file descriptor
+  * @return 0 on success, -1 if the memory couldn't be allocated
+*/
+int open_input(input_t *input, int fd);
+
+/**
+  * Close input function
+  * @brief frees the buffer of an input
+  * @param input the input
+*/
+void close_input(input_t *input);
+
+/**
+  * Read batch function
+  * @brief reads the next frame
+  * @details Frames are separated by one or more blank lines.
+  * @param input the input
+  * @param numbers the buffer of the frame is stored here, free it with free
+  * @param size number of numbers is stored here
+  * @return INPUT_OK, INPUT_END if there are no more frames or the error
+*/
+inputError_t read_batch(input_t *input, comNum_t **numbers, int *size);
+
+/**
+  * Read samples function
+  * @brief reads up to count numbers
+  * @details Fewer are only read at the end of the input.
+  * @param input the input
+  * @param numbers to store the numbers, space for count
+  * @param count most numbers to read
+  * @param got number of numbers read is stored here
+  * @return INPUT_OK or the error
+*/
+inputError_t read_samples(input_t *input, comNum_t *numbers, int count, int *got);
+
+/**
+  * Input pending function
+  * @brief checks for text which was read but not parsed
+  * @details If there is none, the next read may wait for the writer of the input.
+  * @param input the input
+  * @return true if there is such text
+*/
+bool input_pending(const input_t *input);
+
+/**
+  * Input error message function
+  * @brief the message of an input error
+  * @param error the error
+  * @return the message
+*/
+const char *input_error_message(inputError_t error);
+
+#endif
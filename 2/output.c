@@ -0,0 +1,119 @@
+/**
+  * @file output.c
+  * @author
+  * @date 11.12.2022
+  * @brief Implementation of output.h
+*/
+
+#include "output.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <unistd.h>
+
+//10^digits for the precisions used
+static const uint64_t scales[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+//Largest scaled value which fits the integer conversion
+#define MAX_SCALED 9.2e18
+
+
+/**
+  * Format fixed function
+  * @brief formats a float like printf with "%.*f"
+  * @details A float has 24 significant bits and 10^6 less than 15 besides its
+  * power of two, so value*10^digits is exact in double. nearbyint then rounds
+  * it half to even like printf. Values too large for that use snprintf.
+  * @param out to store the text, MAX_LINE/2 characters
+  * @param value the value
+  * @param digits digits after the point, at most 6
+  * @return number of characters
+*/
+static int format_fixed(char *out, float value, int digits){
+    double scaled = (double)value * scales[digits];
+    if(!(fabs(scaled) < MAX_SCALED)){
+        return snprintf(out, MAX_LINE / 2, "%.*f", digits, value);
+    }
+
+    char *p = out;
+    if(signbit(value)){
+        *p++ = '-';
+    }
+    uint64_t units = (uint64_t)nearbyint(fabs(scaled));
+    uint64_t whole = units / scales[digits];
+    uint64_t fraction = units % scales[digits];
+
+    char reversed[20];
+    int count = 0;
+    do{
+        reversed[count++] = '0' + whole % 10;
+        whole /= 10;
+    } while(whole > 0);
+    while(count > 0){
+        *p++ = reversed[--count];
+    }
+
+    if(digits > 0){
+        *p++ = '.';
+        for(int i = digits - 1; i >= 0; i--){
+            p[i] = '0' + fraction % 10;
+            fraction /= 10;
+        }
+        p += digits;
+    }
+    return p - out;
+}
+
+int flush_output(output_t *output){
+    const char *pos = output->buffer;
+    size_t length = output->length;
+    while(length > 0){
+        ssize_t written = write(output->fd, pos, length);
+        if(written == -1){
+            if(errno == EINTR){
+                continue;
+            }
+            return -1;
+        }
+        pos += written;
+        length -= written;
+    }
+    output->length = 0;
+    return 0;
+}
+
+int write_result(output_t *output, bool rounded, comNum_t comNum){
+    if(output->length + MAX_LINE > OUTPUT_BLOCK && flush_output(output) == -1){
+        return -1;
+    }
+
+    float real = comNum.real;
+    float imaginary = comNum.imaginery;
+    int digits = 6;
+    if(rounded){
+        //to tackle the -0.000 problem
+        real = fabsf(real) < 0.0001 ? fabsf(real) : real;
+        imaginary = fabsf(imaginary) < 0.0001 ? fabsf(imaginary) : imaginary;
+        digits = 3;
+    }
+
+    char *p = output->buffer + output->length;
+    p += format_fixed(p, real, digits);
+    *p++ = ' ';
+    p += format_fixed(p, imaginary, digits);
+    memcpy(p, "*i \n", 4);
+    p += 4;
+    output->length = p - output->buffer;
+    return 0;
+}
+
+int write_separator(output_t *output){
+    if(output->length + 1 > OUTPUT_BLOCK && flush_output(output) == -1){
+        return -1;
+    }
+    output->buffer[output->length++] = '\n';
+    return 0;
+}
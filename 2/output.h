@@ -0,0 +1,65 @@
+/**
+  * @file output.h
+  * @author
+  * @date 11.12.2022
+
+  * @brief Header file for writing the results of forkFFT
+  * @details The results are formatted by hand into a large buffer which is
+  * written in big chunks. The text is the same as that of printf with "%f" or,
+  * rounded to 3 digits, "%.3f".
+*/
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdbool.h>
+
+#include "forkFFT.h"
+
+
+//Bytes written at once
+#define OUTPUT_BLOCK (1 << 20)
+
+//Longest line of a result, two %f of FLT_MAX have 2*47 characters
+#define MAX_LINE 128
+
+
+/**
+  * Structure for outputs
+  * @brief The buffer of a file descriptor
+*/
+typedef struct Output{
+    int fd;
+    size_t length;
+    char buffer[OUTPUT_BLOCK];
+} output_t;
+
+
+/**
+  * Write result function
+  * @brief formats a result as "REAL IMAGINARY*i \n"
+  * @details With rounded the parts have 3 digits and parts which are smaller
+  * than 0.0001 are printed without sign, otherwise they have 6 digits.
+  * @param output the output
+  * @param rounded round to 3 digits
+  * @param comNum the result
+  * @return 0 on success, -1 if the full buffer couldn't be written
+*/
+int write_result(output_t *output, bool rounded, comNum_t comNum);
+
+/**
+  * Write separator function
+  * @brief writes the blank line after a frame
+  * @param output the output
+  * @return 0 on success, -1 if the full buffer couldn't be written
+*/
+int write_separator(output_t *output);
+
+/**
+  * Flush output function
+  * @brief writes the buffer
+  * @param output the output
+  * @return 0 on success, -1 on failure
+*/
+int flush_output(output_t *output);
+
+#endif
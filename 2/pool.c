@@ -0,0 +1,178 @@
+/**
+  * @file pool.c
+  * @author
+  * @date 11.12.2022
+  * @brief Implementation of pool.h
+*/
+
+#include "pool.h"
+
+#include <stdlib.h>
+#include <sched.h>
+
+/**
+  * Structure for worker arguments
+  * @brief What a started worker thread gets
+*/
+struct WorkerArgument{
+    pool_t *pool;
+    int worker;
+};
+
+
+int create_pool(pool_t *pool, int workers, long capacity){
+    pool->workers = workers;
+    pool->capacity = capacity;
+    pool->finished = false;
+    pool->threads = NULL;
+    pool->deques = calloc(workers, sizeof(deque_t));
+    if(pool->deques == NULL){
+        return -1;
+    }
+
+    for(int i = 0; i < workers; i++){
+        pool->deques[i].tasks = malloc(sizeof(task_t *) * capacity);
+        if(pool->deques[i].tasks == NULL){
+            pool->workers = i;
+            free_pool(pool);
+            return -1;
+        }
+        pthread_mutex_init(&pool->deques[i].lock, NULL);
+    }
+    return 0;
+}
+
+void free_pool(pool_t *pool){
+    for(int i = 0; i < pool->workers; i++){
+        pthread_mutex_destroy(&pool->deques[i].lock);
+        free(pool->deques[i].tasks);
+    }
+    free(pool->deques);
+    pool->deques = NULL;
+}
+
+void push_task(pool_t *pool, int worker, task_t *task){
+    deque_t *deque = &pool->deques[worker];
+
+    pthread_mutex_lock(&deque->lock);
+    bool full = deque->bottom - deque->top == pool->capacity;
+    if(!full){
+        deque->tasks[deque->bottom % pool->capacity] = task;
+        deque->bottom++;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    //Nothing is lost if the task runs right away
+    if(full){
+        task->run(pool, worker, task);
+    }
+}
+
+/**
+  * Pop task function
+  * @brief takes the newest task of the own deque
+  * @return the task, NULL if the deque is empty
+*/
+static task_t *pop_task(pool_t *pool, int worker){
+    deque_t *deque = &pool->deques[worker];
+    task_t *task = NULL;
+
+    pthread_mutex_lock(&deque->lock);
+    if(deque->bottom > deque->top){
+        deque->bottom--;
+        task = deque->tasks[deque->bottom % pool->capacity];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return task;
+}
+
+/**
+  * Steal task function
+  * @brief takes the oldest task of another worker
+  * @details The victims are tried in order, starting after the thief.
+  * @return the task, NULL if all deques are empty
+*/
+static task_t *steal_task(pool_t *pool, int worker){
+    for(int i = 1; i < pool->workers; i++){
+        deque_t *deque = &pool->deques[(worker + i) % pool->workers];
+        task_t *task = NULL;
+
+        pthread_mutex_lock(&deque->lock);
+        if(deque->bottom > deque->top){
+            task = deque->tasks[deque->top % pool->capacity];
+            deque->top++;
+        }
+        pthread_mutex_unlock(&deque->lock);
+
+        if(task != NULL){
+            return task;
+        }
+    }
+    return NULL;
+}
+
+/**
+  * Work function
+  * @brief the loop of a worker
+  * @param pool the pool
+  * @param worker the worker
+*/
+static void work(pool_t *pool, int worker){
+    while(!__atomic_load_n(&pool->finished, __ATOMIC_ACQUIRE)){
+        task_t *task = pop_task(pool, worker);
+        if(task == NULL){
+            task = steal_task(pool, worker);
+        }
+        if(task == NULL){
+            sched_yield();
+            continue;
+        }
+        task->run(pool, worker, task);
+    }
+}
+
+/**
+  * Start worker function
+  * @brief entry point of the started threads
+*/
+static void *start_worker(void *argument){
+    struct WorkerArgument *worker = argument;
+    work(worker->pool, worker->worker);
+    return NULL;
+}
+
+int run_pool(pool_t *pool, task_t *root){
+    struct WorkerArgument *arguments = malloc(sizeof(struct WorkerArgument) * pool->workers);
+    pool->threads = malloc(sizeof(pthread_t) * pool->workers);
+    if(arguments == NULL || pool->threads == NULL){
+        free(arguments);
+        free(pool->threads);
+        return -1;
+    }
+
+    push_task(pool, 0, root);
+
+    int started = 1;
+    for(; started < pool->workers; started++){
+        arguments[started].pool = pool;
+        arguments[started].worker = started;
+        if(pthread_create(&pool->threads[started], NULL, start_worker, &arguments[started]) != 0){
+            break;
+        }
+    }
+
+    //Workers which couldn't be started are missed by nobody, the others steal their share
+    work(pool, 0);
+
+    for(int i = 1; i < started; i++){
+        pthread_join(pool->threads[i], NULL);
+    }
+    free(arguments);
+    free(pool->threads);
+    pool->threads = NULL;
+    return 0;
+}
+
+void finish_pool(pool_t *pool){
+    __atomic_store_n(&pool->finished, true, __ATOMIC_RELEASE);
+}
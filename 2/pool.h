@@ -0,0 +1,105 @@
+/**
+  * @file pool.h
+  * @author
+  * @date 11.12.2022
+
+  * @brief Header file for the work-stealing thread pool
+  * @details Every worker has its own deque of tasks. A worker pushes and pops
+  * at the bottom of its deque and steals from the top of the others when it
+  * runs out of tasks, so stolen tasks are the big ones near the root.
+*/
+#ifndef POOL_H
+#define POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+
+//Most workers of a pool
+#define MAX_WORKERS 256
+
+struct Pool;
+
+/**
+  * Structure for tasks
+  * @brief A task of the pool
+  * @details Embedded as the first member of the task data,
+  * run gets the task back and casts it.
+*/
+typedef struct Task{
+    void (*run)(struct Pool *pool, int worker, struct Task *task);
+} task_t;
+
+/**
+  * Structure for deques
+  * @brief The tasks of one worker
+  * @details top is where thieves take from, bottom is where the owner
+  * pushes and pops. Both only grow, the slot is the index modulo capacity.
+*/
+typedef struct Deque{
+    pthread_mutex_t lock;
+    task_t **tasks;
+    long top;
+    long bottom;
+} deque_t;
+
+/**
+  * Structure for pools
+  * @brief A work-stealing thread pool
+*/
+typedef struct Pool{
+    int workers;
+    long capacity;
+    deque_t *deques;
+    pthread_t *threads;
+    bool finished;
+} pool_t;
+
+
+/**
+  * Create pool function
+  * @brief creates a pool
+  * @param pool the pool
+  * @param workers number of workers including the calling thread
+  * @param capacity most tasks which are queued at once
+  * @return 0 on success, -1 if the memory couldn't be allocated
+*/
+int create_pool(pool_t *pool, int workers, long capacity);
+
+/**
+  * Free pool function
+  * @brief frees the deques of a pool
+  * @param pool the pool
+*/
+void free_pool(pool_t *pool);
+
+/**
+  * Push task function
+  * @brief queues a task on the deque of a worker
+  * @details Only used by the worker itself while it runs a task.
+  * @param pool the pool
+  * @param worker the worker running the calling task
+  * @param task the task
+*/
+void push_task(pool_t *pool, int worker, task_t *task);
+
+/**
+  * Run pool function
+  * @brief runs tasks until finish_pool is called
+  * @details The calling thread is worker 0 and starts with root,
+  * the other workers are started and joined here. If a thread can't be
+  * started the tasks are run by fewer workers.
+  * @param pool the pool
+  * @param root the first task
+  * @return 0 on success, -1 if the memory couldn't be allocated
+*/
+int run_pool(pool_t *pool, task_t *root);
+
+/**
+  * Finish pool function
+  * @brief lets all workers return once their current task is done
+  * @param pool the pool
+*/
+void finish_pool(pool_t *pool);
+
+#endif
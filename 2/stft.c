@@ -0,0 +1,155 @@
+/**
+  * @file stft.c
+  * @author
+  * @date 11.12.2022
+  * @brief Implementation of stft.h
+*/
+
+#include "stft.h"
+#include "fft.h"
+#include "input.h"
+#include "output.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+
+/**
+  * Structure for STFTs
+  * @brief The state of a running transform
+*/
+typedef struct Stft{
+    const fftPlan_t *plan;
+    float *coefficients;
+    comNum_t *samples;
+    comNum_t *spectrum;
+    input_t input;
+    output_t output;
+    bool rounded;
+} stft_t;
+
+/**
+  * Fill window function
+  * @brief computes the window function
+  * @param coefficients to store the coefficients
+  * @param size samples of a window
+  * @param function the window function
+*/
+static void fill_window(float *coefficients, int size, windowFunction_t function){
+    double a = function == WINDOW_HAMMING ? 0.54 : 0.5;
+    for(int n = 0; n < size; n++){
+        coefficients[n] = a - (1 - a) * cos(2 * M_PI * n / size);
+    }
+}
+
+/**
+  * Emit window function
+  * @brief transforms the samples and writes the spectrum
+  * @details The output is flushed when the next read may wait for the input.
+  * @param stft the transform
+  * @return NULL on success, the message of the error otherwise
+*/
+static const char *emit_window(stft_t *stft){
+    int size = stft->plan->size;
+    for(int n = 0; n < size; n++){
+        stft->spectrum[n].real = stft->samples[n].real * stft->coefficients[n];
+        stft->spectrum[n].imaginery = stft->samples[n].imaginery * stft->coefficients[n];
+    }
+    if(fft(stft->plan, stft->spectrum) == -1){
+        return "Malloc failed";
+    }
+
+    for(int k = 0; k < size; k++){
+        if(write_result(&stft->output, stft->rounded, stft->spectrum[k]) == -1){
+            return "Write failed";
+        }
+    }
+    if(write_separator(&stft->output) == -1
+        || (!input_pending(&stft->input) && flush_output(&stft->output) == -1)){
+        return "Write failed";
+    }
+    return NULL;
+}
+
+/**
+  * Slide function
+  * @brief runs the transform over the whole input
+  * @param stft the transform
+  * @param hop samples between the starts of two windows
+  * @return NULL on success, the message of the error otherwise
+*/
+static const char *slide(stft_t *stft, int hop){
+    int size = stft->plan->size;
+    //samples[0] up to samples[fill] are read, the first covered were in the last window
+    int fill = 0;
+    int covered = 0;
+
+    for(;;){
+        int got;
+        inputError_t error = read_samples(&stft->input, stft->samples + fill, size - fill, &got);
+        if(error != INPUT_OK){
+            return input_error_message(error);
+        }
+        fill += got;
+
+        if(fill < size){
+            if(fill == covered){
+                return NULL;
+            }
+            memset(stft->samples + fill, 0, sizeof(comNum_t) * (size - fill));
+            return emit_window(stft);
+        }
+
+        const char *msg = emit_window(stft);
+        if(msg != NULL){
+            return msg;
+        }
+
+        if(hop < size){
+            memmove(stft->samples, stft->samples + hop, sizeof(comNum_t) * (size - hop));
+            fill = size - hop;
+            covered = fill;
+            continue;
+        }
+
+        //The samples between two windows are skipped
+        fill = 0;
+        covered = 0;
+        for(int skip = hop - size; skip > 0; skip -= got){
+            error = read_samples(&stft->input, stft->samples, skip < size ? skip : size, &got);
+            if(error != INPUT_OK){
+                return input_error_message(error);
+            }
+            if(got == 0){
+                return NULL;
+            }
+        }
+    }
+}
+
+const char *run_stft(int size, int hop, windowFunction_t function, bool rounded){
+    static stft_t stft = {.output = {.fd = STDOUT_FILENO}};
+    stft.rounded = rounded;
+    stft.plan = get_plan(size);
+    stft.coefficients = malloc(sizeof(float) * size);
+    stft.samples = alloc_numbers(size);
+    stft.spectrum = alloc_numbers(size);
+
+    const char *msg = "Malloc failed";
+    if(stft.plan != NULL && stft.coefficients != NULL && stft.samples != NULL && stft.spectrum != NULL
+        && open_input(&stft.input, STDIN_FILENO) == 0){
+        fill_window(stft.coefficients, size, function);
+        msg = slide(&stft, hop);
+        if(flush_output(&stft.output) == -1 && msg == NULL){
+            msg = "Write failed";
+        }
+        close_input(&stft.input);
+    }
+
+    free(stft.coefficients);
+    free(stft.samples);
+    free(stft.spectrum);
+    return msg;
+}
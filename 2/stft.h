@@ -0,0 +1,44 @@
+/**
+  * @file stft.h
+  * @author
+  * @date 11.12.2022
+
+  * @brief Header file for the short-time Fourier transform
+  * @details The input is one long signal. Every hop samples a window of it is
+  * multiplied by the window function and transformed, its results are followed
+  * by a blank line. Only one window of samples is held, the samples it shares
+  * with the next window are kept instead of read again.
+*/
+#ifndef STFT_H
+#define STFT_H
+
+#include <stdbool.h>
+
+#include "forkFFT.h"
+
+
+/**
+  * Window functions
+  * @brief The window functions of the transform
+  * @details Both are periodic, the window of size N repeats after N samples.
+*/
+typedef enum WindowFunction{
+    WINDOW_HANN,
+    WINDOW_HAMMING
+} windowFunction_t;
+
+
+/**
+  * Run STFT function
+  * @brief transforms the windows of stdin and writes them to stdout
+  * @details Only complete windows are transformed, except a last window which
+  * holds samples no earlier window held is padded with zeros.
+  * @param size samples of a window, at least 2
+  * @param hop samples between the starts of two windows, at least 1
+  * @param function the window function
+  * @param rounded round the results to 3 digits
+  * @return NULL on success, the message of the error otherwise
+*/
+const char *run_stft(int size, int hop, windowFunction_t function, bool rounded);
+
+#endif